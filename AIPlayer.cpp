@@ -1,135 +1,609 @@
 ﻿#include "AIPlayer.hpp"
+#include "LayoutPool.hpp"
 #include <random>
 #include <ctime>
+#include <bit>
+#include <stdexcept>
 
 AIPlayer::AIPlayer(std::string name, int boardSize)
-	: Player(name, boardSize)
-	, m_lastHit({ -1, -1 })
+	: AIPlayer(name, boardSize, std::random_device{}())
 {
-	// Генерируем все возможные ходы
-	for (int i = 0; i < boardSize; i++)
-	{
-		for (int j = 0; j < boardSize; j++)
-		{
-			m_allPossibleMoves.push_back({ i, j });
-		}
-	}
-
-	// Перемешиваем ходы
-	std::random_device rd;
-	std::mt19937 gen(rd());
-	std::shuffle(m_allPossibleMoves.begin(), m_allPossibleMoves.end(), gen);
+}
 
-	shipSizes = GameBoard::MakeShipSizes(GameBoard::DEFAULT_SHIP_CONFIG);
+AIPlayer::AIPlayer(std::string name, int boardSize, std::uint32_t seed, Strategy strategy)
+	: AIPlayer(name, GameBoard::MakeRules(boardSize), seed, strategy)
+{
 }
 
-void AIPlayer::PlaceShips()
+AIPlayer::AIPlayer(std::string name, const RuleChoice& rules, std::uint32_t seed, Strategy strategy)
+	: Player(name, rules.boardSize, rules.adjacency)
+	, m_strategy(strategy)
+	, m_sparse(GameBoard::IsSparseSize(rules.boardSize))
+	, m_cellCount(rules.boardSize * rules.boardSize)
+	, m_random(seed)
+	, m_lastHit()
+	, m_moveAvailable(m_sparse ? 0 : m_cellCount, true)
+	, m_cellStates(m_sparse ? 0 : m_cellCount, CellState::eUnknown)
+	, m_useDensityKernel(rules.boardSize <= DensityKernel::MAX_BOARD_SIZE)
+	, m_freeRows{}
+	, m_kernelCounts{}
 {
+	int boardSize = rules.boardSize;
+	if (!IsStrategySupported(strategy, boardSize, rules.adjacency))
+	{
+		throw std::invalid_argument("Стратегии плотности доступны только на полях до GameBoard::MAX_DENSE_BOARD_SIZE и без касаний");
+	}
+
+	// Генерируем все возможные ходы. На большом поле их слишком много,
+	// там клетка для поиска выбирается при ходе (DrawHuntMove)
+	if (!m_sparse)
+	{
+		for (int cell = 0; cell < m_cellCount; cell++)
+		{
+			m_allPossibleMoves.push_back(Cell(cell));
+		}
+
+		// Перемешиваем ходы
+		std::shuffle(m_allPossibleMoves.begin(), m_allPossibleMoves.end(), m_random);
+	}
 
-	std::random_device rd;
-	std::mt19937 gen(rd());
+	shipSizes = rules.shipSizes;
 
+	// Изначально в живых весь флот
 	for (int size : shipSizes)
 	{
-		bool placed = false;
-		int attempts = 0;
-
-		while (!placed && attempts < MAX_ATEMPTS) // Ограничение на попытки
+		if (size >= static_cast<int>(m_remainingShips.size()))
 		{
-			int row = gen() % m_myBoard.GetSize();
-			int col = gen() % m_myBoard.GetSize();
-			bool horizontal = gen() % 2 == 0;
-
-			Ship ship(size, { row, col }, horizontal);
-			placed = m_myBoard.PlaceShip(ship);
-			attempts++;
+			m_remainingShips.resize(size + 1, 0);
 		}
+		m_remainingShips[size]++;
+	}
 
-		if (!placed)
+	// Индекс расстановок нужен только стратегиям плотности. На малых полях
+	// плотность для поиска считает векторное ядро по маскам рядов,
+	// а индекс используется только для добивания.
+	if (m_strategy != Strategy::eRandomHunt)
+	{
+		m_placementIndex = std::make_unique<PlacementIndex>(boardSize, m_remainingShips, !m_useDensityKernel);
+	}
+
+	// Выводы KnowledgeBoard верны только для кораблей без касаний
+	if (!m_sparse && rules.adjacency == RussianRules::ADJACENCY)
+	{
+		m_knowledge = std::make_unique<KnowledgeBoard>(boardSize, m_remainingShips);
+	}
+
+	if (m_useDensityKernel)
+	{
+		for (int row = 0; row < boardSize; row++)
 		{
-			// Если не удалось разместить, пробуем альтернативный алгоритм
-			placed = PlaceShipAlternative(size, gen);
+			m_freeRows[row] = static_cast<std::uint16_t>((1u << boardSize) - 1);
 		}
 	}
 }
 
-bool AIPlayer::PlaceShipAlternative(int size, std::mt19937& gen)
+void AIPlayer::PlaceShips()
+{
+	if (!TryPlaceShips())
+	{
+		throw std::runtime_error("Не удалось расставить флот ИИ");
+	}
+}
+
+bool AIPlayer::TryPlaceShips()
 {
-	// Альтернативный алгоритм размещения корабля
-	for (int attempt = 0; attempt < MAX_ATEMPTS; attempt++)
+	// С пулом расстановка берется готовой и от зерна не зависит
+	if (m_layoutPool && m_layoutFleet != LayoutPool::NO_FLEET && m_layoutPool->PlaceFleet(m_myBoard, m_layoutFleet, shipSizes, m_random))
+	{
+		return true;
+	}
+
+	// Все случайные решения берутся из генератора игрока,
+	// поэтому при одинаковом зерне расстановка повторяется.
+	// Неудачный запуск мог оставить часть флота - поле начинается заново
+	FleetGenerator generator(m_myBoard.GetSize(), shipSizes, m_myBoard.GetAdjacency());
+	for (int tryIndex = 0; tryIndex < MAX_PLACEMENT_TRIES; tryIndex++)
 	{
-		for (bool horizontal : {true, false})
+		m_myBoard = GameBoard(m_myBoard.GetSize(), m_myBoard.GetAdjacency());
+		if (generator.PlaceFleet(m_myBoard, m_random))
 		{
-			for (int row = 0; row < m_myBoard.GetSize(); row++)
-			{
-				for (int col = 0; col < m_myBoard.GetSize(); col++)
-				{
-					Ship ship(size, { row, col }, horizontal);
-					if (m_myBoard.PlaceShip(ship))
-					{
-						return true;
-					}
-				}
-			}
+			return true;
 		}
 	}
+	m_myBoard = GameBoard(m_myBoard.GetSize(), m_myBoard.GetAdjacency());
 	return false;
 }
 
 Player::MoveType AIPlayer::MakeMove()
 {
-	// Если есть потенциальные цели, стреляем в них
-	if (!m_potentialTargets.empty())
+	if (m_strategy != Strategy::eRandomHunt)
+	{
+		return MakeDensityMove();
+	}
+
+	// Если есть потенциальные цели, стреляем в них. Цель могла с тех пор
+	// оказаться пустой по выводам KnowledgeBoard, а на большом поле - уже
+	// простреленной случайным поиском; такие пропускаем
+	while (!m_potentialTargets.empty())
 	{
 		MoveType target = m_potentialTargets.back();
 		m_potentialTargets.pop_back();
-		return target;
+		if (GetCellState(target.GetIndex()) == CellState::eUnknown)
+		{
+			return target;
+		}
+	}
+
+	if (m_sparse)
+	{
+		return DrawHuntMove();
 	}
 
-	// Иначе стреляем в случайную клетку из доступных
-	if (!m_allPossibleMoves.empty())
+	// Иначе стреляем в случайную клетку из доступных. Клетки, взятые в цели,
+	// остаются в перемешанном списке и пропускаются здесь - так порядок
+	// поиска тот же, что при удалении из середины списка. Пропускаются и
+	// клетки, где корабля быть не может
+	while (!m_allPossibleMoves.empty())
 	{
 		MoveType move = m_allPossibleMoves.back();
 		m_allPossibleMoves.pop_back();
-		return move;
+		if (m_moveAvailable[move.GetIndex()] && GetCellState(move.GetIndex()) == CellState::eUnknown)
+		{
+			m_moveAvailable[move.GetIndex()] = false;
+			return move;
+		}
 	}
 
 	// Запасной вариант
-	return { 0, 0 };
+	return MoveType(0);
+}
+
+void AIPlayer::MakeSalvo(int shotCount, SalvoType& salvo)
+{
+	// Результаты придут после всего залпа, поэтому выбранные клетки временно
+	// исключаются из выбора (для плотности они выглядят как промах) и
+	// возвращаются перед записью результатов
+	salvo.clear();
+	for (int shot = 0; shot < shotCount; shot++)
+	{
+		// Повтор или клетка, в которую уже стреляли, - выбирать больше не из чего
+		MoveType move = MakeMove();
+		if (move.GetIndex() < 0 || move.GetIndex() >= m_cellCount ||
+			std::find(salvo.begin(), salvo.end(), move) != salvo.end())
+		{
+			break;
+		}
+		CellState state = GetCellState(move.GetIndex());
+		if (state == CellState::eMiss || state == CellState::eHit || state == CellState::eSunk)
+		{
+			break;
+		}
+		salvo.push_back(move);
+		ReserveCell(move.GetIndex());
+	}
+
+	for (MoveType move : salvo)
+	{
+		ReleaseCell(move.GetIndex());
+	}
 }
 
 void AIPlayer::UpdateAIState(Ship::ShotResult result, MoveType coord)
 {
+	RecordShot(result, coord);
+
+	// Списки ходов нужны только случайному поиску
+	if (m_strategy != Strategy::eRandomHunt)
+	{
+		return;
+	}
+
 	if (result == Ship::ShotResult::eHit)
 	{
 		m_lastHit = coord;
 
-		// Добавляем соседние клетки как потенциальные цели
+		// Добавляем соседние клетки как потенциальные цели. Если рядом уже есть
+		// попадание, направление корабля известно - цели только вдоль него
+		KnowledgeBoard::Axis axis = m_knowledge ? m_knowledge->GetAxis(coord.GetIndex()) : KnowledgeBoard::Axis::eUnknown;
 		int directions[4][2] = { {0, 1}, {1, 0}, {0, -1}, {-1, 0} };
 		for (auto& dir : directions)
 		{
-			int newRow = coord.first + dir[0];
-			int newCol = coord.second + dir[1];
+			if ((axis == KnowledgeBoard::Axis::eHorizontal && dir[0] != 0) ||
+				(axis == KnowledgeBoard::Axis::eVertical && dir[1] != 0))
+			{
+				continue;
+			}
+
+			int newRow = coord.GetRow(m_myBoard.GetSize()) + dir[0];
+			int newCol = coord.GetCol(m_myBoard.GetSize()) + dir[1];
 
 			if (newRow >= 0 && newRow < m_myBoard.GetSize() &&
 				newCol >= 0 && newCol < m_myBoard.GetSize())
 			{
-				MoveType newTarget = { newRow, newCol };
+				MoveType newTarget = MoveType::FromRowCol(newRow, newCol, m_myBoard.GetSize());
 
 				// Проверяем, что этот ход еще возможен
-				auto it = std::find(m_allPossibleMoves.begin(), m_allPossibleMoves.end(), newTarget);
-				if (it != m_allPossibleMoves.end())
+				if (m_sparse)
+				{
+					if (GetCellState(newTarget.GetIndex()) == CellState::eUnknown &&
+						std::find(m_potentialTargets.begin(), m_potentialTargets.end(), newTarget) == m_potentialTargets.end())
+					{
+						m_potentialTargets.push_back(newTarget);
+					}
+					continue;
+				}
+				if (m_moveAvailable[newTarget.GetIndex()] && GetCellState(newTarget.GetIndex()) == CellState::eUnknown)
 				{
 					m_potentialTargets.push_back(newTarget);
-					m_allPossibleMoves.erase(it);
+					m_moveAvailable[newTarget.GetIndex()] = false;
 				}
 			}
 		}
 	}
 	else if (result == Ship::ShotResult::eSunk)
 	{
-		// Очищаем потенциальные цели при потоплении корабля
-		m_potentialTargets.clear();
-		m_lastHit = { -1, -1 };
+		// Снимаем потенциальные цели вокруг потопленного корабля. Цели рядом
+		// с попаданиями в другие корабли (в залпе их может быть несколько) остаются
+		m_potentialTargets.erase(std::remove_if(m_potentialTargets.begin(), m_potentialTargets.end(),
+			[this](MoveType target) { return GetCellState(target.GetIndex()) != CellState::eUnknown; }),
+			m_potentialTargets.end());
+		m_lastHit = Cell();
+	}
+}
+
+void AIPlayer::RecordShot(Ship::ShotResult result, MoveType coord)
+{
+	int index = coord.GetIndex();
+	if (index < 0 || index >= m_cellCount)
+	{
+		return;
+	}
+
+	switch (result)
+	{
+	case Ship::ShotResult::eMiss:
+		SetCellState(index, CellState::eMiss);
+		CloseFreeCell(index);
+		if (m_placementIndex)
+		{
+			m_placementIndex->MarkEmpty(index);
+		}
+		if (m_knowledge)
+		{
+			m_knowledge->MarkMiss(index, m_inferredCells);
+			ApplyInferredCells();
+		}
+		break;
+	case Ship::ShotResult::eHit:
+	case Ship::ShotResult::eSunk:
+		if (GetCellState(index) != CellState::eHit)
+		{
+			SetCellState(index, CellState::eHit);
+			CloseFreeCell(index);
+			m_unresolvedHits.push_back(index);
+			if (m_placementIndex)
+			{
+				m_placementIndex->MarkHit(index);
+			}
+			if (m_knowledge)
+			{
+				m_knowledge->MarkHit(index, m_inferredCells);
+				ApplyInferredCells();
+			}
+		}
+		if (result == Ship::ShotResult::eSunk)
+		{
+			MarkSunkShip(coord);
+		}
+		break;
+	case Ship::ShotResult::eAlreadyShot:
+		break;
+	}
+}
+
+void AIPlayer::MarkSunkShip(MoveType coord)
+{
+	int size = m_myBoard.GetSize();
+	GameBoard::Adjacency adjacency = m_myBoard.GetAdjacency();
+
+	// Без касаний и с касанием углами корабли не соседствуют сторонами, поэтому
+	// связная по сторонам группа попаданий - это и есть потопленный корабль.
+	// Вплотную попадания соседних кораблей сливаются: известна только клетка
+	// последнего выстрела, остальные попадания остаются незавершенными
+	CellsType shipCells;
+	CellsType stack = { coord.GetIndex() };
+	SetCellState(stack.back(), CellState::eSunk);
+	if (adjacency == GameBoard::Adjacency::eTouch)
+	{
+		shipCells.swap(stack);
+	}
+
+	while (!stack.empty())
+	{
+		int cell = stack.back();
+		stack.pop_back();
+		shipCells.push_back(cell);
+
+		int directions[4][2] = { {0, 1}, {1, 0}, {0, -1}, {-1, 0} };
+		for (auto& dir : directions)
+		{
+			int row = cell / size + dir[0];
+			int col = cell % size + dir[1];
+			if (row >= 0 && row < size && col >= 0 && col < size &&
+				GetCellState(CellIndex(row, col)) == CellState::eHit)
+			{
+				SetCellState(CellIndex(row, col), CellState::eSunk);
+				stack.push_back(CellIndex(row, col));
+			}
+		}
+	}
+
+	// Клетки корабля больше не считаются незавершенными попаданиями
+	m_unresolvedHits.erase(std::remove_if(m_unresolvedHits.begin(), m_unresolvedHits.end(),
+		[this](int cell) { return GetCellState(cell) == CellState::eSunk; }), m_unresolvedHits.end());
+
+	if (m_placementIndex)
+	{
+		m_placementIndex->MarkSunk(shipCells);
+	}
+
+	// В окрестности потопленного корабля (по правилу касания) других кораблей
+	// быть не может. На обычном поле это и остальные следствия выводит KnowledgeBoard
+	if (m_knowledge)
+	{
+		m_knowledge->MarkSunk(shipCells, m_inferredCells);
+		ApplyInferredCells();
+	}
+	else if (adjacency != GameBoard::Adjacency::eTouch)
+	{
+		for (int cell : shipCells)
+		{
+			int shipRow = cell / size;
+			int shipCol = cell % size;
+			for (int row = std::max(shipRow - 1, 0); row <= std::min(shipRow + 1, size - 1); row++)
+			{
+				for (int col = std::max(shipCol - 1, 0); col <= std::min(shipCol + 1, size - 1); col++)
+				{
+					if (PlacementTables::IsInHalo(adjacency, row, col, shipRow, shipCol, shipRow, shipCol))
+					{
+						MarkEmptyCell(CellIndex(row, col));
+					}
+				}
+			}
+		}
+	}
+
+	// Длина корабля, потопленного вплотную к другим, неизвестна
+	int length = static_cast<int>(shipCells.size());
+	if (adjacency != GameBoard::Adjacency::eTouch && length < static_cast<int>(m_remainingShips.size()) && m_remainingShips[length] > 0)
+	{
+		m_remainingShips[length]--;
+	}
+}
+
+void AIPlayer::MarkEmptyCell(int index)
+{
+	if (GetCellState(index) != CellState::eUnknown)
+	{
+		return;
+	}
+	SetCellState(index, CellState::eEmpty);
+	CloseFreeCell(index);
+	if (m_placementIndex)
+	{
+		m_placementIndex->MarkEmpty(index);
+	}
+}
+
+void AIPlayer::ApplyInferredCells()
+{
+	for (int cell : m_inferredCells)
+	{
+		MarkEmptyCell(cell);
+	}
+}
+
+Player::MoveType AIPlayer::MakeDensityMove()
+{
+	// Есть подбитый корабль - выбираем среди расстановок, проходящих через попадания
+	int cell = -1;
+	if (!m_unresolvedHits.empty() && m_strategy == Strategy::eMonteCarlo)
+	{
+		cell = SelectSampledTargetCell();
+	}
+	if (!m_unresolvedHits.empty() && cell < 0)
+	{
+		cell = m_placementIndex->SelectTargetCell(m_unresolvedHits, m_random);
 	}
-}
\ No newline at end of file
+
+	// Иначе клетка с наибольшей плотностью, равные варианты выбираются случайно
+	if (cell < 0)
+	{
+		cell = m_useDensityKernel ? SelectKernelHuntCell() : m_placementIndex->SelectHuntCell(m_random);
+	}
+
+	// Запасной вариант
+	if (cell < 0)
+	{
+		return MoveType(0);
+	}
+	return MoveType(cell);
+}
+
+int AIPlayer::SelectKernelHuntCell()
+{
+	// Без незавершенных попаданий расстановка возможна тогда и только тогда,
+	// когда все ее клетки неизвестны, поэтому подсчет по маскам точен
+	int size = m_myBoard.GetSize();
+	DensityKernel::Count(m_freeRows, size, m_remainingShips, m_kernelCounts);
+
+	int best = -1;
+	int bestCell = -1;
+	unsigned ties = 0;
+	for (int row = 0; row < size; row++)
+	{
+		for (unsigned bits = m_freeRows[row]; bits != 0; bits &= bits - 1)
+		{
+			int col = std::countr_zero(bits);
+			int density = m_kernelCounts[row * DensityKernel::MAX_BOARD_SIZE + col];
+			if (density > best)
+			{
+				best = density;
+				bestCell = CellIndex(row, col);
+				ties = 1;
+			}
+			else if (density == best && m_random() % ++ties == 0)
+			{
+				bestCell = CellIndex(row, col);
+			}
+		}
+	}
+	return bestCell;
+}
+
+int AIPlayer::SelectSampledTargetCell()
+{
+	// Выборки учитывают взаимодействие кораблей (касание, пересечение),
+	// которое подсчет отдельных расстановок игнорирует
+	FleetSampler sampler(MakeObservation());
+	int chains = std::max(m_samplerSettings.chains, 1);
+	long long samplesPerChain = std::max((m_samplerSettings.samples + chains - 1) / chains, 1);
+	FleetSampler::Result result = sampler.Run(samplesPerChain, chains, m_samplerSettings.threads, m_random(), &m_samplerChains);
+	if (result.samples == 0)
+	{
+		return -1;
+	}
+
+	int best = 0;
+	int bestCell = -1;
+	unsigned ties = 0;
+	for (int cell = 0; cell < static_cast<int>(m_cellStates.size()); cell++)
+	{
+		if (m_cellStates[cell] != CellState::eUnknown)
+		{
+			continue;
+		}
+
+		int count = result.hitCounts[cell];
+		if (count > best)
+		{
+			best = count;
+			bestCell = cell;
+			ties = 1;
+		}
+		else if (count == best && count > 0 && m_random() % ++ties == 0)
+		{
+			bestCell = cell;
+		}
+	}
+	return bestCell;
+}
+
+FleetSampler::Observation AIPlayer::MakeObservation() const
+{
+	FleetSampler::Observation observation;
+	observation.boardSize = m_myBoard.GetSize();
+	observation.hitCells = m_unresolvedHits;
+
+	// Оставшиеся корабли могут стоять только на неизвестных клетках и незавершенных попаданиях
+	observation.allowedCells.resize(m_cellStates.size());
+	for (size_t cell = 0; cell < m_cellStates.size(); cell++)
+	{
+		observation.allowedCells[cell] = m_cellStates[cell] == CellState::eUnknown || m_cellStates[cell] == CellState::eHit;
+	}
+
+	for (int length = 1; length < static_cast<int>(m_remainingShips.size()); length++)
+	{
+		observation.shipLengths.insert(observation.shipLengths.end(), m_remainingShips[length], length);
+	}
+	return observation;
+}
+
+void AIPlayer::CloseFreeCell(int index)
+{
+	if (m_useDensityKernel)
+	{
+		int size = m_myBoard.GetSize();
+		m_freeRows[index / size] &= static_cast<std::uint16_t>(~(1u << (index % size)));
+	}
+}
+
+void AIPlayer::OpenFreeCell(int index)
+{
+	if (m_useDensityKernel)
+	{
+		int size = m_myBoard.GetSize();
+		m_freeRows[index / size] |= static_cast<std::uint16_t>(1u << (index % size));
+	}
+}
+
+void AIPlayer::ReserveCell(int index)
+{
+	if (GetCellState(index) != CellState::eUnknown)
+	{
+		return;
+	}
+	SetCellState(index, CellState::eReserved);
+	CloseFreeCell(index);
+	if (m_placementIndex)
+	{
+		m_placementIndex->ReserveCell(index);
+	}
+}
+
+void AIPlayer::ReleaseCell(int index)
+{
+	if (GetCellState(index) != CellState::eReserved)
+	{
+		return;
+	}
+	SetCellState(index, CellState::eUnknown);
+	OpenFreeCell(index);
+	if (m_placementIndex)
+	{
+		m_placementIndex->ReleaseCell(index);
+	}
+}
+
+void AIPlayer::SetCellState(int index, CellState state)
+{
+	if (!m_sparse)
+	{
+		m_cellStates[index] = state;
+	}
+	else if (state == CellState::eUnknown)
+	{
+		m_sparseCellStates.erase(index);
+	}
+	else
+	{
+		m_sparseCellStates[index] = state;
+	}
+}
+
+Player::MoveType AIPlayer::DrawHuntMove()
+{
+	// Ходы большого поля не перечисляются заранее: случайная клетка
+	// берется заново, пока не попадется неизвестная
+	std::uniform_int_distribution<int> pick(0, m_cellCount - 1);
+	for (int draw = 0; draw < MAX_HUNT_DRAWS; draw++)
+	{
+		int cell = pick(m_random);
+		if (GetCellState(cell) == CellState::eUnknown)
+		{
+			return MoveType(cell);
+		}
+	}
+
+	// Почти все поле известно - ищем по порядку от случайной клетки
+	int first = pick(m_random);
+	for (int i = 0; i < m_cellCount; i++)
+	{
+		int cell = (first + i) % m_cellCount;
+		if (GetCellState(cell) == CellState::eUnknown)
+		{
+			return MoveType(cell);
+		}
+	}
+	return MoveType(0);
+}
@@ -2,34 +2,149 @@
 
 #include "Player.hpp"
 #include "GameBoard.hpp"
+#include "PlacementIndex.hpp"
+#include "KnowledgeBoard.hpp"
+#include "DensityKernel.hpp"
+#include "FleetSampler.hpp"
+#include "FleetGenerator.hpp"
 #include <vector>
+#include <unordered_map>
+#include <memory>
 #include <algorithm>
 #include <random>
+#include <cstdint>
 
 class AIPlayer : public Player
 {
 public:
-	static const int MAX_ATEMPTS = 100;
+	static const int DEFAULT_SAMPLER_SAMPLES = 1000;   // Выборок расстановок на один выстрел добивания
+	static const int MAX_HUNT_DRAWS = 64;      // Случайных клеток на ход поиска большого поля до перебора по порядку
+	static const int MAX_PLACEMENT_TRIES = 4;  // Запусков генератора (по FleetGenerator::MAX_ATTEMPTS попыток) до отказа
+
+	// Стратегия выбора выстрела
+	enum class Strategy
+	{
+		eRandomHunt = 0,          // Случайный поиск и добивание соседних клеток
+		eProbabilityDensity = 1,  // Выстрел в клетку с наибольшим числом возможных расстановок
+		eMonteCarlo = 2           // Как плотность, но добивание по выборкам целого флота (FleetSampler)
+	};
+
+	// Что ИИ знает о клетке поля противника
+	enum class CellState : std::uint8_t
+	{
+		eUnknown = 0,
+		eMiss = 1,
+		eHit = 2,     // Попадание в еще не потопленный корабль
+		eSunk = 3,
+		eEmpty = 4,   // Кораблей быть не может (вывод KnowledgeBoard или соседство с потопленным)
+		eReserved = 5 // Уже выбрана в текущий залп, результат еще неизвестен
+	};
+
+	// Выборка флота для добивания (стратегия eMonteCarlo). Она занимает почти
+	// все время хода: 1000 выборок одной цепью - около 2 мс на выстрел добивания
+	// поля 10x10, то есть около 12 партий ИИ против ИИ в секунду на одном ядре
+	// (плотность без выборки - около 4000). Время растет линейно с числом выборок;
+	// потоки стоит давать только когда партии не идут параллельно (Tournament
+	// уже занимает все ядра). Цепи продолжаются с прошлого хода, пока флот
+	// не меняется, и пропускают поиск начальной расстановки и прогрев
+	struct SamplerSettings
+	{
+		int samples = DEFAULT_SAMPLER_SAMPLES;   // Всего на выстрел, делятся между цепями
+		int chains = 1;
+		int threads = 1;
+	};
 
 	// публичные: переопределение типом
 	using TargetsType = std::vector<MoveType>;
-	using MovesType = std::vector<MoveType>;
+	using MovesType = std::vector<Cell>;   // Список строится только на плотном поле - хватает 16 бит
+	using CellStatesType = std::vector<CellState>;
+	using SparseCellStatesType = std::unordered_map<int, CellState>;   // Только известные клетки
+	using ShipCountsType = std::vector<int>;
+	using CellsType = std::vector<int>;
 
 public:
 	// конструкторы и деконструктор
 	AIPlayer(std::string name, int boardSize);
+	AIPlayer(std::string name, int boardSize, std::uint32_t seed,
+		Strategy strategy = Strategy::eRandomHunt);
+	AIPlayer(std::string name, const RuleChoice& rules, std::uint32_t seed,
+		Strategy strategy = Strategy::eRandomHunt);
 	~AIPlayer() override = default;
 
 	// публичные методы
-	void PlaceShips() override;
+	void PlaceShips() override;   // Бросает исключение, если флот не расставился
+	bool TryPlaceShips();         // false - флот не расставился, поле пустое
 	MoveType MakeMove() override;
+	void MakeSalvo(int shotCount, SalvoType& salvo) override;
 	void UpdateAIState(Ship::ShotResult result, MoveType coord);
-	bool PlaceShipAlternative(int size, std::mt19937& gen);
+
+	// Стратегиям плотности нужны таблицы расстановок с маской поля на каждую
+	// расстановку, поэтому на большом (разреженном) поле доступен только
+	// случайный поиск. Их выводы (KnowledgeBoard, индекс расстановок, выборка
+	// флота) считают, что корабли не касаются, поэтому при других правилах
+	// касания тоже доступен только случайный поиск. Конструктор
+	// с неподдерживаемой стратегией бросает исключение
+	static bool IsStrategySupported(Strategy strategy, int boardSize, GameBoard::Adjacency adjacency = RussianRules::ADJACENCY)
+	{
+		return strategy == Strategy::eRandomHunt || (!GameBoard::IsSparseSize(boardSize) && adjacency == RussianRules::ADJACENCY);
+	}
+
+	void SetSamplerSettings(const SamplerSettings& settings) { m_samplerSettings = settings; }
+
+	// геттеры
+	Strategy GetStrategy() const { return m_strategy; }
+	const SamplerSettings& GetSamplerSettings() const { return m_samplerSettings; }
+
+private:
+	// приватные методы
+	int CellIndex(int row, int col) const { return row * m_myBoard.GetSize() + col; }
+	CellState GetCellState(int index) const
+	{
+		if (!m_sparse)
+		{
+			return m_cellStates[index];
+		}
+		auto it = m_sparseCellStates.find(index);
+		return it == m_sparseCellStates.end() ? CellState::eUnknown : it->second;
+	}
+	void SetCellState(int index, CellState state);
+	MoveType DrawHuntMove();
+	void RecordShot(Ship::ShotResult result, MoveType coord);
+	void MarkSunkShip(MoveType coord);
+	void MarkEmptyCell(int index);
+	void ApplyInferredCells();
+	MoveType MakeDensityMove();
+	int SelectKernelHuntCell();
+	int SelectSampledTargetCell();
+	FleetSampler::Observation MakeObservation() const;
+	void CloseFreeCell(int index);
+	void OpenFreeCell(int index);
+	void ReserveCell(int index);
+	void ReleaseCell(int index);
 
 private:
 	// приватные переменные
+	Strategy m_strategy;
+	bool m_sparse;                     // Большое поле: ничего не хранится на каждую клетку
+	int m_cellCount;
+	std::mt19937 m_random;
 	MoveType m_lastHit;
 	TargetsType m_potentialTargets;
-	MovesType m_allPossibleMoves;
+	MovesType m_allPossibleMoves;      // Порядок случайного поиска; взятые клетки снимаются с конца
+	std::vector<bool> m_moveAvailable; // [клетка] - ход еще не сделан и не взят в цели
 	GameBoard::ShipSizesType shipSizes;
+
+	// Знания о поле противника
+	CellStatesType m_cellStates;
+	SparseCellStatesType m_sparseCellStates;
+	ShipCountsType m_remainingShips;   // Число непотопленных кораблей по длине
+	CellsType m_unresolvedHits;        // Попадания в еще не потопленные корабли
+	std::unique_ptr<PlacementIndex> m_placementIndex;
+	std::unique_ptr<KnowledgeBoard> m_knowledge;   // Выводы по правилам; только на обычном поле
+	CellsType m_inferredCells;                     // Пустые клетки последнего вывода KnowledgeBoard
+	bool m_useDensityKernel;                   // Поле не больше DensityKernel::MAX_BOARD_SIZE
+	DensityKernel::RowMasksType m_freeRows;    // Неизвестные клетки по рядам
+	DensityKernel::CountsType m_kernelCounts;
+	SamplerSettings m_samplerSettings;
+	FleetSampler::ChainStatesType m_samplerChains;   // Расстановки цепей после прошлой выборки
 };
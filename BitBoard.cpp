@@ -0,0 +1,121 @@
+﻿#include "BitBoard.hpp"
+#include <bit>
+
+BitBoard::BitBoard(int bitCount)
+	: m_bitCount(bitCount)
+	, m_wordCount((bitCount + WORD_BITS - 1) / WORD_BITS)
+	, m_inlineWords{}
+{
+	// Большие поля не помещаются во встроенный буфер
+	if (m_wordCount > INLINE_WORDS)
+	{
+		m_heapWords.assign(m_wordCount, 0);
+	}
+}
+
+void BitBoard::Clear()
+{
+	WordType* words = Words();
+	for (int i = 0; i < m_wordCount; i++)
+	{
+		words[i] = 0;
+	}
+}
+
+int BitBoard::Count() const
+{
+	const WordType* words = Words();
+	int count = 0;
+	for (int i = 0; i < m_wordCount; i++)
+	{
+		count += std::popcount(words[i]);
+	}
+	return count;
+}
+
+bool BitBoard::Any() const
+{
+	const WordType* words = Words();
+	for (int i = 0; i < m_wordCount; i++)
+	{
+		if (words[i] != 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool BitBoard::Intersects(const BitBoard& other) const
+{
+	const WordType* words = Words();
+	const WordType* otherWords = other.Words();
+	for (int i = 0; i < m_wordCount; i++)
+	{
+		if ((words[i] & otherWords[i]) != 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+// Маска задана готовым массивом из GetWordCount() слов (например, таблицей позиций)
+bool BitBoard::Intersects(const WordType* words) const
+{
+	const WordType* ownWords = Words();
+	for (int i = 0; i < m_wordCount; i++)
+	{
+		if ((ownWords[i] & words[i]) != 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool BitBoard::IsSubsetOf(const BitBoard& other) const
+{
+	const WordType* words = Words();
+	const WordType* otherWords = other.Words();
+	for (int i = 0; i < m_wordCount; i++)
+	{
+		if ((words[i] & ~otherWords[i]) != 0)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+int BitBoard::CountAnd(const BitBoard& other) const
+{
+	const WordType* words = Words();
+	const WordType* otherWords = other.Words();
+	int count = 0;
+	for (int i = 0; i < m_wordCount; i++)
+	{
+		count += std::popcount(words[i] & otherWords[i]);
+	}
+	return count;
+}
+
+BitBoard& BitBoard::operator|=(const BitBoard& other)
+{
+	WordType* words = Words();
+	const WordType* otherWords = other.Words();
+	for (int i = 0; i < m_wordCount; i++)
+	{
+		words[i] |= otherWords[i];
+	}
+	return *this;
+}
+
+void BitBoard::Add(const WordType* words)
+{
+	WordType* ownWords = Words();
+	for (int i = 0; i < m_wordCount; i++)
+	{
+		ownWords[i] |= words[i];
+	}
+}
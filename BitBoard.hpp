@@ -0,0 +1,53 @@
+﻿#pragma once
+
+#include <array>
+#include <vector>
+#include <cstdint>
+
+// Битовая маска клеток поля (индекс клетки = ряд * размер + столбец).
+// Поле до 128 клеток (стандартное 10x10) хранится прямо в объекте,
+// для больших полей используется массив 64-битных слов.
+class BitBoard
+{
+public:
+	using WordType = std::uint64_t;
+
+	static const int WORD_BITS = 64;
+	static const int INLINE_WORDS = 2;
+
+public:
+	// конструкторы и деконструктор
+	BitBoard(int bitCount = 0);
+	~BitBoard() = default;
+
+	// публичные методы
+	bool Test(int index) const { return (Words()[index / WORD_BITS] >> (index % WORD_BITS)) & 1; }
+	void Set(int index) { Words()[index / WORD_BITS] |= WordType(1) << (index % WORD_BITS); }
+	void Reset(int index) { Words()[index / WORD_BITS] &= ~(WordType(1) << (index % WORD_BITS)); }
+	void Clear();
+	int Count() const;
+	bool Any() const;
+	bool Intersects(const BitBoard& other) const;
+	bool Intersects(const WordType* words) const;
+	bool IsSubsetOf(const BitBoard& other) const;
+	int CountAnd(const BitBoard& other) const;
+	BitBoard& operator|=(const BitBoard& other);
+	void Add(const WordType* words);
+
+	// геттеры
+	int GetBitCount() const { return m_bitCount; }
+	int GetWordCount() const { return m_wordCount; }
+	WordType GetWord(int index) const { return Words()[index]; }
+
+private:
+	// приватные методы
+	WordType* Words() { return m_heapWords.empty() ? m_inlineWords.data() : m_heapWords.data(); }
+	const WordType* Words() const { return m_heapWords.empty() ? m_inlineWords.data() : m_heapWords.data(); }
+
+private:
+	// приватные переменные
+	int m_bitCount;
+	int m_wordCount;
+	std::array<WordType, INLINE_WORDS> m_inlineWords;
+	std::vector<WordType> m_heapWords;
+};
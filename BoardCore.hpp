@@ -0,0 +1,394 @@
+﻿#pragma once
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <type_traits>
+#include <span>
+#include <bit>
+#include "Cell.hpp"
+#include "Ship.hpp"
+#include "BitBoard.hpp"
+#include "PlacementTables.hpp"
+#include "BoardSnapshot.hpp"
+
+// Состояние поля, специализированное по размеру N. Для N > 0 все данные
+// лежат в std::array внутри объекта, циклы имеют известное при компиляции
+// число шагов, и куча не используется. BoardCore<0> - тот же код для
+// размера, заданного во время выполнения (std::vector вместо std::array).
+// Правило касания ADJACENCY - тоже параметр шаблона: оно выбирает таблицы
+// окрестностей, и проверка позиции не ветвится по правилам.
+// Корабль хранится как начальная клетка, длина и ориентация; клетки поля
+// ссылаются на номер корабля, число оставшихся палуб ведется по кораблям.
+// Символьные виды поля для владельца и противника хранятся готовыми и
+// обновляются в PlaceShip и ReceiveShot, поэтому отрисовка ничего не строит.
+// ApplyShot возвращает запись для UndoShot: перебор вариантов выстрела
+// делается и отменяется на месте, без копирования поля. Поле фиксированного
+// размера сохраняется в BoardSnapshot<N> и восстанавливается из него.
+
+// Отмена одного выстрела: клетка и результат, по ним восстанавливается все остальное.
+// Плотное поле пишет в журнал 16-битную Cell, большое - WideCell
+template <class CellType>
+struct BasicShotUndo
+{
+	CellType cell;              // CellType() - выстрел ничего не изменил
+	Ship::ShotResult result;
+};
+
+using ShotUndo = BasicShotUndo<Cell>;
+using WideShotUndo = BasicShotUndo<WideCell>;
+
+template <int N, PlacementTables::Adjacency ADJACENCY = PlacementTables::Adjacency::eNoTouch>
+class BoardCore
+{
+public:
+	static const bool IS_STATIC = N > 0;
+	static const bool HAS_SNAPSHOT = IS_STATIC && ADJACENCY == PlacementTables::Adjacency::eNoTouch;
+	static const int CELL_COUNT = N * N;
+	static const int WORD_COUNT = (CELL_COUNT + BitBoard::WORD_BITS - 1) / BitBoard::WORD_BITS;
+	// Без касаний - не больше одного корабля на квадрат 2x2; с касанием углами
+	// клетки разных кораблей не соседствуют сторонами, как клетки одного цвета
+	// шахматной доски; вплотную - не больше одного корабля на клетку
+	static const int MAX_SHIPS =
+		ADJACENCY == PlacementTables::Adjacency::eNoTouch ? ((N + 1) / 2) * ((N + 1) / 2) :
+		ADJACENCY == PlacementTables::Adjacency::eDiagonal ? (CELL_COUNT + 1) / 2 : CELL_COUNT;
+	static constexpr int NO_SHIP = -1;
+	static constexpr char VIEW_UNKNOWN = '.';
+	static constexpr char VIEW_SHIP = 'S';
+	static constexpr char VIEW_HIT = 'X';
+	static constexpr char VIEW_MISS = 'O';
+
+	// Положение корабля на поле
+	struct ShipRecord
+	{
+		int start;
+		std::uint8_t size;
+		bool isHorizontal;
+
+		bool operator==(const ShipRecord& other) const = default;
+	};
+
+	// публичные: переопределение типом
+	using WordType = BitBoard::WordType;
+	using MaskType = std::conditional_t<IS_STATIC, std::array<WordType, WORD_COUNT>, std::vector<WordType>>;
+	using StaticShipIdType = std::conditional_t<MAX_SHIPS <= INT8_MAX, std::int8_t, std::int16_t>;
+	using ShipIdType = std::conditional_t<IS_STATIC, StaticShipIdType, int>;
+	using ShipIdsType = std::conditional_t<IS_STATIC, std::array<ShipIdType, CELL_COUNT>, std::vector<ShipIdType>>;
+	using ShipRecordsType = std::conditional_t<IS_STATIC, std::array<ShipRecord, MAX_SHIPS>, std::vector<ShipRecord>>;
+	using RemainingHitsType = std::conditional_t<IS_STATIC, std::array<std::uint8_t, MAX_SHIPS>, std::vector<int>>;
+	using ViewBufferType = std::conditional_t<IS_STATIC, std::array<char, CELL_COUNT>, std::vector<char>>;
+	using ViewType = std::span<const char>;   // [row * size + col]
+	using UndoType = ShotUndo;
+
+public:
+	// конструкторы и деконструктор
+	explicit BoardCore(int size = N)
+		: m_size(IS_STATIC ? N : size)
+		, m_tables(IS_STATIC ? nullptr : &PlacementTables::GetSizeTables(size, ADJACENCY))
+		, m_shipCount(0)
+		, m_aliveShipCount(0)
+		, m_remainingShipCells(0)
+		, m_ships{}
+		, m_remainingHits{}
+	{
+		int words = (m_size * m_size + BitBoard::WORD_BITS - 1) / BitBoard::WORD_BITS;
+		if constexpr (IS_STATIC)
+		{
+			m_occupied.fill(0);
+			m_blocked.fill(0);
+			m_shots.fill(0);
+			m_misses.fill(0);
+			m_cellShips.fill(NO_SHIP);
+			m_ownerView.fill(VIEW_UNKNOWN);
+			m_opponentView.fill(VIEW_UNKNOWN);
+			(void)words;
+		}
+		else
+		{
+			m_occupied.assign(words, 0);
+			m_blocked.assign(words, 0);
+			m_shots.assign(words, 0);
+			m_misses.assign(words, 0);
+			m_cellShips.assign(m_size * m_size, NO_SHIP);
+			m_ownerView.assign(m_size * m_size, VIEW_UNKNOWN);
+			m_opponentView.assign(m_size * m_size, VIEW_UNKNOWN);
+		}
+	}
+	// Восстановление из снимка: корабли ставятся в прежнем порядке (те же номера),
+	// затем повторяются выстрелы по маске
+	explicit BoardCore(const BoardSnapshot<N>& snapshot) requires HAS_SNAPSHOT
+		: BoardCore()
+	{
+		for (int ship = 0; ship < snapshot.shipCount; ship++)
+		{
+			int start = snapshot.shipStarts[ship];
+			int shape = snapshot.shipShapes[ship];
+			PlaceShip(shape & ~BoardSnapshot<N>::HORIZONTAL_FLAG, start / N, start % N,
+				(shape & BoardSnapshot<N>::HORIZONTAL_FLAG) != 0);
+		}
+		for (int word = 0; word < WORD_COUNT; word++)
+		{
+			for (WordType bits = snapshot.shots[word]; bits != 0; bits &= bits - 1)
+			{
+				ApplyShot(word * BitBoard::WORD_BITS + std::countr_zero(bits));
+			}
+		}
+	}
+	~BoardCore() = default;
+
+	// публичные методы
+	void TakeSnapshot(BoardSnapshot<N>& snapshot) const requires HAS_SNAPSHOT
+	{
+		snapshot = {};
+		snapshot.shots = m_shots;
+		snapshot.shipCount = static_cast<std::uint8_t>(m_shipCount);
+		for (int ship = 0; ship < m_shipCount; ship++)
+		{
+			snapshot.shipStarts[ship] = static_cast<typename BoardSnapshot<N>::StartType>(m_ships[ship].start);
+			snapshot.shipShapes[ship] = static_cast<std::uint8_t>(m_ships[ship].size |
+				(m_ships[ship].isHorizontal ? BoardSnapshot<N>::HORIZONTAL_FLAG : 0));
+		}
+	}
+
+	bool CanPlaceShip(int size, int row, int col, bool isHorizontal) const
+	{
+		int endRow = isHorizontal ? row : row + size - 1;
+		int endCol = isHorizontal ? col + size - 1 : col;
+		if (size <= 0 || row < 0 || col < 0 || endRow >= GetSize() || endCol >= GetSize() || IsFleetFull())
+		{
+			return false;
+		}
+
+		const PlacementTables::Table& table = GetTable(size, isHorizontal);
+		const WordType* footprint = table.GetFootprint(table.GetIndex(row, col));
+		for (int word = 0; word < GetWordCount(); word++)
+		{
+			if (footprint[word] & m_blocked[word])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool PlaceShip(int size, int row, int col, bool isHorizontal)
+	{
+		if (!CanPlaceShip(size, row, col, isHorizontal))
+		{
+			return false;
+		}
+
+		const PlacementTables::Table& table = GetTable(size, isHorizontal);
+		int placement = table.GetIndex(row, col);
+		const WordType* footprint = table.GetFootprint(placement);
+		const WordType* halo = table.GetHalo(placement);
+		for (int word = 0; word < GetWordCount(); word++)
+		{
+			m_occupied[word] |= footprint[word];
+			m_blocked[word] |= halo[word];
+		}
+
+		// Запоминаем, какому кораблю принадлежит каждая клетка; владелец видит свои корабли
+		int start = CellIndex(row, col);
+		int step = isHorizontal ? 1 : GetSize();
+		for (int i = 0; i < size; i++)
+		{
+			m_cellShips[start + i * step] = static_cast<ShipIdType>(m_shipCount);
+			m_ownerView[start + i * step] = VIEW_SHIP;
+		}
+
+		ShipRecord record{ start, static_cast<std::uint8_t>(size), isHorizontal };
+		if constexpr (IS_STATIC)
+		{
+			m_ships[m_shipCount] = record;
+			m_remainingHits[m_shipCount] = static_cast<std::uint8_t>(size);
+		}
+		else
+		{
+			m_ships.push_back(record);
+			m_remainingHits.push_back(size);
+		}
+		m_shipCount++;
+		m_aliveShipCount++;
+		m_remainingShipCells += size;
+		return true;
+	}
+
+	Ship::ShotResult ReceiveShot(int index) { return ApplyShot(index).result; }
+
+	// Залп: выстрелы разрешаются по порядку за один проход, results[i] - результат cells[i]
+	template <class CellType>
+	void ReceiveShots(std::span<const CellType> cells, std::span<Ship::ShotResult> results)
+	{
+		for (size_t i = 0; i < cells.size(); i++)
+		{
+			results[i] = ApplyShot(cells[i].GetIndex()).result;
+		}
+	}
+
+	ShotUndo ApplyShot(int index)
+	{
+		// Выстрел за пределы поля считаем промахом и не запоминаем
+		if (index < 0 || index >= GetSize() * GetSize())
+		{
+			return { Cell(), Ship::ShotResult::eMiss };
+		}
+
+		if (TestBit(m_shots, index))
+		{
+			return { Cell(), Ship::ShotResult::eAlreadyShot };
+		}
+		SetBit(m_shots, index);
+
+		// Корабль в клетке определяется по таблице без перебора флота
+		int shipId = m_cellShips[index];
+		if (shipId == NO_SHIP)
+		{
+			SetBit(m_misses, index);
+			m_ownerView[index] = VIEW_MISS;
+			m_opponentView[index] = VIEW_MISS;
+			return { Cell(index), Ship::ShotResult::eMiss };
+		}
+
+		m_ownerView[index] = VIEW_HIT;
+		m_opponentView[index] = VIEW_HIT;
+		m_remainingShipCells--;
+		if (--m_remainingHits[shipId] == 0)
+		{
+			m_aliveShipCount--;
+			return { Cell(index), Ship::ShotResult::eSunk };
+		}
+		return { Cell(index), Ship::ShotResult::eHit };
+	}
+
+	// Отмена должна идти в обратном порядке выстрелов
+	void UndoShot(const ShotUndo& undo)
+	{
+		if (!undo.cell.IsValid())
+		{
+			return;
+		}
+
+		int index = undo.cell.GetIndex();
+		ResetBit(m_shots, index);
+		m_opponentView[index] = VIEW_UNKNOWN;
+
+		int shipId = m_cellShips[index];
+		if (shipId == NO_SHIP)
+		{
+			ResetBit(m_misses, index);
+			m_ownerView[index] = VIEW_UNKNOWN;
+			return;
+		}
+
+		m_ownerView[index] = VIEW_SHIP;
+		m_remainingShipCells++;
+		if (m_remainingHits[shipId]++ == 0)
+		{
+			m_aliveShipCount++;
+		}
+	}
+
+	bool operator==(const BoardCore& other) const = default;
+
+	bool IsAllShipsSunk() const { return m_remainingShipCells == 0; }
+	bool IsShot(int index) const { return TestBit(m_shots, index); }
+	bool IsOccupied(int index) const { return TestBit(m_occupied, index); }
+	char GetViewCell(bool forOwner, int index) const { return forOwner ? m_ownerView[index] : m_opponentView[index]; }
+
+	// геттеры
+	constexpr int GetSize() const
+	{
+		if constexpr (IS_STATIC)
+		{
+			return N;
+		}
+		else
+		{
+			return m_size;
+		}
+	}
+	int GetShipCount() const { return m_shipCount; }
+	int GetAliveShipCount() const { return m_aliveShipCount; }
+	const ShipRecord& GetShipRecord(int shipId) const { return m_ships[shipId]; }
+	int GetRemainingHits(int shipId) const { return m_remainingHits[shipId]; }
+	ViewType GetView(bool forOwner) const
+	{
+		const ViewBufferType& view = forOwner ? m_ownerView : m_opponentView;
+		return ViewType(view.data(), view.size());
+	}
+
+private:
+	// приватные методы
+	int CellIndex(int row, int col) const { return row * GetSize() + col; }
+	// У BoardCore<0> таблицы найдены в конструкторе (SizeTables) и читаются без блокировки.
+	// У BoardCore<N> таблицы стандартных длин готовы при компиляции, а длинные
+	// корабли берутся из SizeTables поля N, найденных один раз на программу
+	const PlacementTables::Table& GetTable(int size, bool isHorizontal) const
+	{
+		if constexpr (IS_STATIC)
+		{
+			if (size <= PlacementTables::STANDARD_MAX_LENGTH)
+			{
+				return PlacementTables::Get(N, size, isHorizontal, ADJACENCY);
+			}
+			static const PlacementTables::SizeTables& longTables = PlacementTables::GetSizeTables(N, ADJACENCY);
+			return longTables.Get(size, isHorizontal);
+		}
+		else
+		{
+			return m_tables->Get(size, isHorizontal);
+		}
+	}
+	constexpr int GetWordCount() const
+	{
+		if constexpr (IS_STATIC)
+		{
+			return WORD_COUNT;
+		}
+		else
+		{
+			return static_cast<int>(m_occupied.size());
+		}
+	}
+	bool IsFleetFull() const
+	{
+		if constexpr (IS_STATIC)
+		{
+			return m_shipCount >= MAX_SHIPS;
+		}
+		else
+		{
+			return false;
+		}
+	}
+	static bool TestBit(const MaskType& mask, int index)
+	{
+		return (mask[index / BitBoard::WORD_BITS] >> (index % BitBoard::WORD_BITS)) & 1;
+	}
+	static void SetBit(MaskType& mask, int index)
+	{
+		mask[index / BitBoard::WORD_BITS] |= WordType(1) << (index % BitBoard::WORD_BITS);
+	}
+	static void ResetBit(MaskType& mask, int index)
+	{
+		mask[index / BitBoard::WORD_BITS] &= ~(WordType(1) << (index % BitBoard::WORD_BITS));
+	}
+
+private:
+	// приватные переменные
+	int m_size;
+	const PlacementTables::SizeTables* m_tables;   // Только BoardCore<0>
+	int m_shipCount;
+	int m_aliveShipCount;
+	int m_remainingShipCells;
+	MaskType m_occupied;
+	MaskType m_blocked;
+	MaskType m_shots;
+	MaskType m_misses;
+	ShipIdsType m_cellShips;
+	ShipRecordsType m_ships;
+	RemainingHitsType m_remainingHits;
+	ViewBufferType m_ownerView;      // Корабли, попадания и промахи
+	ViewBufferType m_opponentView;   // Только попадания и промахи
+};
@@ -0,0 +1,34 @@
+﻿#pragma once
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include "BitBoard.hpp"
+
+// Снимок поля фиксированного размера N без указателей: маска выстрелов и
+// расстановка кораблей. Остальное состояние BoardCore (кому принадлежит
+// клетка, сколько палуб осталось, виды) однозначно восстанавливается
+// по ним, поэтому снимок стандартного поля занимает меньше 128 байт и
+// копируется одним memcpy - например, между потоками или в общую память.
+template <int N>
+struct BoardSnapshot
+{
+	static_assert(N > 0, "Снимок есть только у полей фиксированного размера");
+
+	static const int CELL_COUNT = N * N;
+	static const int WORD_COUNT = (CELL_COUNT + BitBoard::WORD_BITS - 1) / BitBoard::WORD_BITS;
+	static const int MAX_SHIPS = ((N + 1) / 2) * ((N + 1) / 2);
+	static const std::uint8_t HORIZONTAL_FLAG = 0x80;   // Старший бит shipShapes, остальные - длина
+
+	// публичные: переопределение типом
+	using WordType = BitBoard::WordType;
+	using StartType = std::conditional_t<CELL_COUNT <= 256, std::uint8_t, std::uint16_t>;
+
+	std::array<WordType, WORD_COUNT> shots;
+	std::array<StartType, MAX_SHIPS> shipStarts;    // Индекс начальной клетки
+	std::array<std::uint8_t, MAX_SHIPS> shipShapes; // Длина | HORIZONTAL_FLAG
+	std::uint8_t shipCount;
+};
+
+static_assert(std::is_trivially_copyable_v<BoardSnapshot<10>>, "Снимок копируется побайтно");
+static_assert(sizeof(BoardSnapshot<10>) < 128, "Снимок стандартного поля должен быть меньше 128 байт");
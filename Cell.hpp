@@ -0,0 +1,61 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <cassert>
+
+// Клетка поля: индекс ряд * размер + столбец. Координаты ряда и столбца
+// нужны только на границе с пользователем (ввод, вывод), весь остальной код
+// работает с индексом и обращается по нему к таблицам клеток.
+// Cell хранит индекс в 16 битах - ею пользуются плотные поля (BoardCore),
+// журналы выстрелов и списки ходов ИИ. WideCell - 32 бита для SparseBoardCore
+// и для хода игрока, который может прийти на поле любого размера. Узкая
+// клетка расширяется неявно, широкая сужается только явно. Индекс, который
+// не помещается в клетку, не сужается молча, а останавливает программу (assert).
+template <class IndexT, IndexT INVALID, int MAX_SIZE>
+class BasicCell
+{
+public:
+	// публичные: переопределение типом
+	using IndexType = IndexT;
+
+	static constexpr IndexType INVALID_INDEX = INVALID;
+	static constexpr int MAX_BOARD_SIZE = MAX_SIZE;
+
+public:
+	// конструкторы и деконструктор
+	constexpr BasicCell() : m_index(INVALID_INDEX) {}
+	constexpr explicit BasicCell(int index) : m_index(static_cast<IndexType>(index))
+	{
+		assert(IsIndexInRange(index) && "Индекс клетки не помещается в тип клетки");
+	}
+	template <class OtherIndexT, OtherIndexT OTHER_INVALID, int OTHER_MAX_SIZE>
+	constexpr explicit(sizeof(OtherIndexT) > sizeof(IndexT)) BasicCell(const BasicCell<OtherIndexT, OTHER_INVALID, OTHER_MAX_SIZE>& other)
+		: m_index(other.IsValid() ? static_cast<IndexType>(other.GetIndex()) : INVALID_INDEX)
+	{
+		assert((!other.IsValid() || IsIndexInRange(other.GetIndex())) && "Индекс клетки не помещается в тип клетки");
+	}
+
+	// публичные методы
+	static constexpr BasicCell FromRowCol(int row, int col, int boardSize) { return BasicCell(row * boardSize + col); }
+	constexpr bool IsValid() const { return m_index != INVALID_INDEX; }
+	constexpr bool operator==(const BasicCell& other) const { return m_index == other.m_index; }
+	constexpr bool operator!=(const BasicCell& other) const { return m_index != other.m_index; }
+	constexpr bool operator<(const BasicCell& other) const { return m_index < other.m_index; }
+
+	static constexpr bool IsIndexInRange(long long index) { return index >= 0 && index < static_cast<long long>(INVALID_INDEX); }
+
+	// геттеры
+	constexpr int GetIndex() const { return IsValid() ? static_cast<int>(m_index) : -1; }
+	constexpr int GetRow(int boardSize) const { return m_index / boardSize; }
+	constexpr int GetCol(int boardSize) const { return m_index % boardSize; }
+
+private:
+	// приватные переменные
+	IndexType m_index;
+};
+
+using Cell = BasicCell<std::uint16_t, 0xFFFF, 255>;               // 255 * 255 клеток помещаются вместе с INVALID_INDEX
+using WideCell = BasicCell<std::uint32_t, 0xFFFFFFFF, 46340>;     // Индекс любой клетки помещается в int
+
+static_assert(sizeof(Cell) == 2, "Клетка должна занимать 16 бит");
+static_assert(sizeof(WideCell) == 4, "Широкая клетка должна занимать 32 бита");
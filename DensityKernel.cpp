@@ -0,0 +1,310 @@
+﻿#include "DensityKernel.hpp"
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define DENSITY_KERNEL_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC и Clang разрешают AVX2-инструкции только в функциях с этим атрибутом,
+// MSVC - в любом месте; выбор реализации делается во время выполнения
+#if defined(__GNUC__) || defined(__clang__)
+#define DENSITY_KERNEL_AVX2 __attribute__((target("avx2")))
+#else
+#define DENSITY_KERNEL_AVX2
+#endif
+
+namespace
+{
+	using Lanes = std::array<std::uint16_t, DensityKernel::MAX_BOARD_SIZE * DensityKernel::MAX_BOARD_SIZE>;
+
+	// Маски только с клетками внутри поля
+	DensityKernel::RowMasksType ClipRows(const DensityKernel::RowMasksType& rows, int boardSize)
+	{
+		DensityKernel::RowMasksType clipped{};
+		std::uint16_t inside = static_cast<std::uint16_t>((1u << boardSize) - 1);
+		for (int row = 0; row < boardSize; row++)
+		{
+			clipped[row] = rows[row] & inside;
+		}
+		return clipped;
+	}
+
+	int MaxLength(const DensityKernel::ShipCountsType& shipCounts, int boardSize)
+	{
+		return std::min(static_cast<int>(shipCounts.size()) - 1, boardSize);
+	}
+
+	// Сложение проходов по рядам (out[col][row]) и по столбцам (out[row][col])
+	void Combine(const Lanes& byRows, const Lanes& byColumns, int boardSize, DensityKernel::CountsType& counts)
+	{
+		const int stride = DensityKernel::MAX_BOARD_SIZE;
+		counts.fill(0);
+		for (int row = 0; row < boardSize; row++)
+		{
+			for (int col = 0; col < boardSize; col++)
+			{
+				counts[row * stride + col] = static_cast<std::uint16_t>(byRows[col * stride + row] + byColumns[row * stride + col]);
+			}
+		}
+	}
+
+#if DENSITY_KERNEL_X86
+	// Один проход по 16 маскам: out[bit * 16 + lane] - сумма весов отрезков, накрывающих бит.
+	// Для бита b число отрезков длины L, накрывающих его, равно числу начал
+	// в окне [b - L + 1, b]; окно сдвигается на один бит за шаг.
+	void PassSSE2(const DensityKernel::RowMasksType& masks, int boardSize,
+		const DensityKernel::ShipCountsType& shipCounts, bool withSingles, Lanes& out)
+	{
+		const __m128i one = _mm_set1_epi16(1);
+		const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(masks.data()));
+		const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(masks.data() + 8));
+
+		__m128i accLow[DensityKernel::MAX_BOARD_SIZE];
+		__m128i accHigh[DensityKernel::MAX_BOARD_SIZE];
+		for (int bit = 0; bit < boardSize; bit++)
+		{
+			accLow[bit] = _mm_setzero_si128();
+			accHigh[bit] = _mm_setzero_si128();
+		}
+
+		for (int length = withSingles ? 1 : 2; length <= MaxLength(shipCounts, boardSize); length++)
+		{
+			if (shipCounts[length] == 0)
+			{
+				continue;
+			}
+
+			// Бит i начала: клетки i..i+length-1 свободны
+			__m128i startLow = low;
+			__m128i startHigh = high;
+			for (int shift = 1; shift < length; shift++)
+			{
+				__m128i count = _mm_cvtsi32_si128(shift);
+				startLow = _mm_and_si128(startLow, _mm_srl_epi16(low, count));
+				startHigh = _mm_and_si128(startHigh, _mm_srl_epi16(high, count));
+			}
+
+			const __m128i weight = _mm_set1_epi16(static_cast<short>(shipCounts[length]));
+			__m128i enterLow = startLow, enterHigh = startHigh;
+			__m128i leaveLow = startLow, leaveHigh = startHigh;
+			__m128i runLow = _mm_setzero_si128(), runHigh = _mm_setzero_si128();
+			for (int bit = 0; bit < boardSize; bit++)
+			{
+				runLow = _mm_add_epi16(runLow, _mm_and_si128(enterLow, one));
+				runHigh = _mm_add_epi16(runHigh, _mm_and_si128(enterHigh, one));
+				enterLow = _mm_srli_epi16(enterLow, 1);
+				enterHigh = _mm_srli_epi16(enterHigh, 1);
+				if (bit >= length)
+				{
+					runLow = _mm_sub_epi16(runLow, _mm_and_si128(leaveLow, one));
+					runHigh = _mm_sub_epi16(runHigh, _mm_and_si128(leaveHigh, one));
+					leaveLow = _mm_srli_epi16(leaveLow, 1);
+					leaveHigh = _mm_srli_epi16(leaveHigh, 1);
+				}
+				accLow[bit] = _mm_add_epi16(accLow[bit], _mm_mullo_epi16(runLow, weight));
+				accHigh[bit] = _mm_add_epi16(accHigh[bit], _mm_mullo_epi16(runHigh, weight));
+			}
+		}
+
+		for (int bit = 0; bit < boardSize; bit++)
+		{
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out.data() + bit * 16), accLow[bit]);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out.data() + bit * 16 + 8), accHigh[bit]);
+		}
+	}
+
+	DENSITY_KERNEL_AVX2 void PassAVX2(const DensityKernel::RowMasksType& masks, int boardSize,
+		const DensityKernel::ShipCountsType& shipCounts, bool withSingles, Lanes& out)
+	{
+		const __m256i one = _mm256_set1_epi16(1);
+		const __m256i rows = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(masks.data()));
+
+		__m256i acc[DensityKernel::MAX_BOARD_SIZE];
+		for (int bit = 0; bit < boardSize; bit++)
+		{
+			acc[bit] = _mm256_setzero_si256();
+		}
+
+		for (int length = withSingles ? 1 : 2; length <= MaxLength(shipCounts, boardSize); length++)
+		{
+			if (shipCounts[length] == 0)
+			{
+				continue;
+			}
+
+			__m256i start = rows;
+			for (int shift = 1; shift < length; shift++)
+			{
+				start = _mm256_and_si256(start, _mm256_srl_epi16(rows, _mm_cvtsi32_si128(shift)));
+			}
+
+			const __m256i weight = _mm256_set1_epi16(static_cast<short>(shipCounts[length]));
+			__m256i enter = start;
+			__m256i leave = start;
+			__m256i run = _mm256_setzero_si256();
+			for (int bit = 0; bit < boardSize; bit++)
+			{
+				run = _mm256_add_epi16(run, _mm256_and_si256(enter, one));
+				enter = _mm256_srli_epi16(enter, 1);
+				if (bit >= length)
+				{
+					run = _mm256_sub_epi16(run, _mm256_and_si256(leave, one));
+					leave = _mm256_srli_epi16(leave, 1);
+				}
+				acc[bit] = _mm256_add_epi16(acc[bit], _mm256_mullo_epi16(run, weight));
+			}
+		}
+
+		for (int bit = 0; bit < boardSize; bit++)
+		{
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out.data() + bit * 16), acc[bit]);
+		}
+	}
+
+	// Транспонирование 16x16 бит: знаковые биты дорожек собираются через movemask
+	DensityKernel::RowMasksType TransposeSSE2(const DensityKernel::RowMasksType& rows, int boardSize)
+	{
+		const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows.data()));
+		const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows.data() + 8));
+
+		DensityKernel::RowMasksType columns{};
+		for (int col = 0; col < boardSize; col++)
+		{
+			__m128i count = _mm_cvtsi32_si128(15 - col);
+			__m128i packed = _mm_packs_epi16(_mm_sll_epi16(low, count), _mm_sll_epi16(high, count));
+			columns[col] = static_cast<std::uint16_t>(_mm_movemask_epi8(packed));
+		}
+		return columns;
+	}
+
+	bool CpuHasAVX2()
+	{
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 1);
+		bool osSavesYmm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && ((_xgetbv(0) & 6) == 6);
+		__cpuidex(info, 7, 0);
+		return osSavesYmm && (info[1] & (1 << 5));
+#else
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+#endif
+}
+
+DensityKernel::Backend DensityKernel::GetBestBackend()
+{
+#if DENSITY_KERNEL_X86
+	static const Backend best = CpuHasAVX2() ? Backend::eAVX2 : Backend::eSSE2;
+	return best;
+#else
+	return Backend::eScalar;
+#endif
+}
+
+void DensityKernel::Count(const RowMasksType& freeRows, int boardSize, const ShipCountsType& shipCounts,
+	CountsType& counts)
+{
+	Count(freeRows, boardSize, shipCounts, counts, GetBestBackend());
+}
+
+void DensityKernel::Count(const RowMasksType& freeRows, int boardSize, const ShipCountsType& shipCounts,
+	CountsType& counts, Backend backend)
+{
+#if DENSITY_KERNEL_X86
+	if (backend != Backend::eScalar && boardSize > 0 && boardSize <= MAX_BOARD_SIZE)
+	{
+		RowMasksType rows = ClipRows(freeRows, boardSize);
+		RowMasksType columns = TransposeSSE2(rows, boardSize);
+
+		// Однопалубные корабли не имеют ориентации и считаются только в рядах
+		Lanes byRows;
+		Lanes byColumns;
+		if (backend == Backend::eAVX2)
+		{
+			PassAVX2(rows, boardSize, shipCounts, true, byRows);
+			PassAVX2(columns, boardSize, shipCounts, false, byColumns);
+		}
+		else
+		{
+			PassSSE2(rows, boardSize, shipCounts, true, byRows);
+			PassSSE2(columns, boardSize, shipCounts, false, byColumns);
+		}
+
+		Combine(byRows, byColumns, boardSize, counts);
+		return;
+	}
+#endif
+
+	CountScalar(freeRows, boardSize, shipCounts, counts);
+}
+
+void DensityKernel::CountScalar(const RowMasksType& freeRows, int boardSize, const ShipCountsType& shipCounts,
+	CountsType& counts)
+{
+	// Эталон: перебор всех расстановок по одной
+	counts.fill(0);
+	RowMasksType rows = ClipRows(freeRows, boardSize);
+	auto isFree = [&rows](int row, int col) { return (rows[row] >> col) & 1; };
+
+	for (int length = 1; length <= MaxLength(shipCounts, boardSize); length++)
+	{
+		int weight = shipCounts[length];
+		if (weight == 0)
+		{
+			continue;
+		}
+
+		for (bool horizontal : { true, false })
+		{
+			if (length == 1 && !horizontal)
+			{
+				continue;
+			}
+
+			int rowsCount = horizontal ? boardSize : boardSize - length + 1;
+			int colsCount = horizontal ? boardSize - length + 1 : boardSize;
+			for (int row = 0; row < rowsCount; row++)
+			{
+				for (int col = 0; col < colsCount; col++)
+				{
+					bool fits = true;
+					for (int i = 0; i < length && fits; i++)
+					{
+						fits = horizontal ? isFree(row, col + i) : isFree(row + i, col);
+					}
+					if (!fits)
+					{
+						continue;
+					}
+
+					for (int i = 0; i < length; i++)
+					{
+						int cell = horizontal ? row * MAX_BOARD_SIZE + col + i : (row + i) * MAX_BOARD_SIZE + col;
+						counts[cell] = static_cast<std::uint16_t>(counts[cell] + weight);
+					}
+				}
+			}
+		}
+	}
+}
+
+DensityKernel::RowMasksType DensityKernel::Transpose(const RowMasksType& rows, int boardSize)
+{
+	RowMasksType columns{};
+	for (int row = 0; row < boardSize; row++)
+	{
+		for (int col = 0; col < boardSize; col++)
+		{
+			if ((rows[row] >> col) & 1)
+			{
+				columns[col] |= static_cast<std::uint16_t>(1u << row);
+			}
+		}
+	}
+	return columns;
+}
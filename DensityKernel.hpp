@@ -0,0 +1,42 @@
+﻿#pragma once
+
+#include <array>
+#include <vector>
+#include <cstdint>
+
+// Векторный подсчет плотности расстановок для полей до 16x16.
+// Поле задается масками свободных клеток по рядам (бит col ряда row).
+// Для каждой длины корабля ищутся все отрезки из length свободных клеток
+// в рядах и столбцах, и каждой клетке отрезка добавляется число
+// оставшихся кораблей этой длины. Шестнадцать рядов обрабатываются
+// одновременно в 16-битных дорожках SSE2 (два регистра) или AVX2 (один);
+// столбцы - тем же ядром над транспонированными масками.
+class DensityKernel
+{
+public:
+	static const int MAX_BOARD_SIZE = 16;
+
+	// Реализация подсчета
+	enum class Backend
+	{
+		eScalar = 0,
+		eSSE2 = 1,
+		eAVX2 = 2
+	};
+
+	// публичные: переопределение типом
+	using RowMasksType = std::array<std::uint16_t, MAX_BOARD_SIZE>;
+	using CountsType = std::array<std::uint16_t, MAX_BOARD_SIZE * MAX_BOARD_SIZE>;  // [row * MAX_BOARD_SIZE + col]
+	using ShipCountsType = std::vector<int>;
+
+public:
+	// публичные методы
+	static Backend GetBestBackend();
+	static void Count(const RowMasksType& freeRows, int boardSize, const ShipCountsType& shipCounts,
+		CountsType& counts, Backend backend);
+	static void Count(const RowMasksType& freeRows, int boardSize, const ShipCountsType& shipCounts,
+		CountsType& counts);
+	static void CountScalar(const RowMasksType& freeRows, int boardSize, const ShipCountsType& shipCounts,
+		CountsType& counts);
+	static RowMasksType Transpose(const RowMasksType& rows, int boardSize);
+};
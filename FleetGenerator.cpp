@@ -0,0 +1,231 @@
+﻿#include "FleetGenerator.hpp"
+#include <algorithm>
+#include <numeric>
+
+FleetGenerator::FleetGenerator(int boardSize, const GameBoard::ShipSizesType& shipSizes, Adjacency adjacency)
+	: m_boardSize(boardSize)
+	, m_adjacency(adjacency)
+	, m_sparse(GameBoard::IsSparseSize(boardSize))
+	, m_wordCount(m_sparse ? 0 : (boardSize * boardSize + BitBoard::WORD_BITS - 1) / BitBoard::WORD_BITS)
+	, m_shipSizes(shipSizes)
+	, m_counts(m_sparse ? nullptr : LayoutCountTable::Get(boardSize, shipSizes, adjacency))
+	, m_blocked(m_wordCount, 0)
+	, m_picks(shipSizes.size(), -1)
+	, m_attempts(0)
+{
+	// Длинные корабли первыми: неудачная попытка обрывается раньше
+	m_order.resize(m_shipSizes.size());
+	std::iota(m_order.begin(), m_order.end(), 0);
+	std::stable_sort(m_order.begin(), m_order.end(),
+		[this](int a, int b) { return m_shipSizes[a] > m_shipSizes[b]; });
+
+	// Большому полю и полю с таблицей чисел расстановок таблицы позиций не нужны
+	if (m_sparse || m_counts)
+	{
+		return;
+	}
+
+	int maxSize = m_shipSizes.empty() ? 0 : *std::max_element(m_shipSizes.begin(), m_shipSizes.end());
+	m_candidates.resize(std::max(maxSize, 0) + 1);
+
+	for (int size = 1; size <= maxSize; size++)
+	{
+		// Однопалубный корабль не имеет ориентации
+		Candidates& candidates = m_candidates[size];
+		candidates.tables[0] = &PlacementTables::Get(m_boardSize, size, true, m_adjacency);
+		candidates.tables[1] = size == 1 ? nullptr : &PlacementTables::Get(m_boardSize, size, false, m_adjacency);
+		candidates.count = candidates.tables[0]->GetCount() + (candidates.tables[1] ? candidates.tables[1]->GetCount() : 0);
+	}
+}
+
+bool FleetGenerator::Generate(std::mt19937& random, LayoutType& layout)
+{
+	if (m_sparse)
+	{
+		GameBoard board(m_boardSize);
+		return PlaceSequentially(board, random, layout);
+	}
+	if (m_counts)
+	{
+		m_attempts = 1;
+		if (m_counts->GetLayoutCount() == 0)
+		{
+			return false;
+		}
+		MakeCountedLayout(random, layout);
+		return true;
+	}
+
+	for (int size : m_shipSizes)
+	{
+		if (size <= 0 || m_candidates[size].count == 0)
+		{
+			return false;
+		}
+	}
+
+	for (m_attempts = 1; m_attempts <= MAX_ATTEMPTS; m_attempts++)
+	{
+		if (TryRandomLayout(random))
+		{
+			MakeLayout(layout);
+			return true;
+		}
+	}
+	return false;
+}
+
+bool FleetGenerator::PlaceFleet(GameBoard& board, std::mt19937& random)
+{
+	// Правило касания генератора должно совпадать с правилом поля
+	LayoutType layout;
+	if (board.GetSize() != m_boardSize || m_adjacency != board.GetAdjacency())
+	{
+		return false;
+	}
+	if (m_sparse)
+	{
+		return PlaceSequentially(board, random, layout);
+	}
+	if (!Generate(random, layout))
+	{
+		return false;
+	}
+
+	for (const Placement& placement : layout)
+	{
+		if (!board.PlaceShip(placement.size, placement.start, placement.isHorizontal))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool FleetGenerator::TryRandomLayout(std::mt19937& random)
+{
+	std::fill(m_blocked.begin(), m_blocked.end(), 0);
+	for (int ship : m_order)
+	{
+		const Candidates& candidates = m_candidates[m_shipSizes[ship]];
+		std::uniform_int_distribution<int> pick(0, candidates.count - 1);
+		int candidate = pick(random);
+
+		// Горизонтальные позиции идут первыми, вертикальные - за ними
+		int horizontalCount = candidates.tables[0]->GetCount();
+		const PlacementTables::Table& table = *candidates.tables[candidate >= horizontalCount];
+		int index = candidate >= horizontalCount ? candidate - horizontalCount : candidate;
+		if (!Fits(table, index))
+		{
+			return false;
+		}
+
+		Block(table, index);
+		m_picks[ship] = candidate;
+	}
+	return true;
+}
+
+void FleetGenerator::MakeCountedLayout(std::mt19937& random, LayoutType& layout)
+{
+	// В таблице корабли одной длины неразличимы: выбранные позиции раздаются им
+	// в случайном порядке, чтобы равновероятной была и расстановка по номерам кораблей
+	m_counts->Sample(random, m_sampled);
+	std::shuffle(m_sampled.begin(), m_sampled.end(), random);
+	std::stable_sort(m_sampled.begin(), m_sampled.end(),
+		[](const LayoutCountTable::Pick& a, const LayoutCountTable::Pick& b) { return a.length > b.length; });
+
+	// m_order - те же корабли по убыванию длины
+	layout.assign(m_shipSizes.size(), Placement{ 0, WideCell(), true });
+	for (size_t i = 0; i < m_order.size(); i++)
+	{
+		const LayoutCountTable::Pick& pick = m_sampled[i];
+		layout[m_order[i]] = Placement{ pick.length, WideCell(pick.start), pick.isHorizontal };
+	}
+}
+
+const PlacementTables::Table& FleetGenerator::Resolve(const Candidates& candidates, int& index)
+{
+	int horizontalCount = candidates.tables[0]->GetCount();
+	if (index < horizontalCount)
+	{
+		return *candidates.tables[0];
+	}
+	index -= horizontalCount;
+	return *candidates.tables[1];
+}
+
+bool FleetGenerator::Fits(const PlacementTables::Table& table, int index) const
+{
+	const WordType* footprint = table.GetFootprint(index);
+	for (int word = 0; word < m_wordCount; word++)
+	{
+		if (footprint[word] & m_blocked[word])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void FleetGenerator::Block(const PlacementTables::Table& table, int index)
+{
+	const WordType* halo = table.GetHalo(index);
+	for (int word = 0; word < m_wordCount; word++)
+	{
+		m_blocked[word] |= halo[word];
+	}
+}
+
+void FleetGenerator::MakeLayout(LayoutType& layout) const
+{
+	layout.clear();
+	for (size_t ship = 0; ship < m_shipSizes.size(); ship++)
+	{
+		int index = m_picks[ship];
+		const PlacementTables::Table& table = Resolve(m_candidates[m_shipSizes[ship]], index);
+		layout.push_back(Placement{ m_shipSizes[ship], WideCell(table.GetStart(index)), table.horizontal });
+	}
+}
+
+bool FleetGenerator::PlaceSequentially(GameBoard& board, std::mt19937& random, LayoutType& layout)
+{
+	layout.assign(m_shipSizes.size(), Placement{ 0, WideCell(), true });
+	m_attempts = 0;
+	for (int ship : m_order)
+	{
+		// Позиции нумеруются так же, как в таблицах: горизонтальные, затем вертикальные
+		int size = m_shipSizes[ship];
+		long long lineStarts = static_cast<long long>(m_boardSize) - size + 1;
+		long long horizontalCount = lineStarts > 0 ? m_boardSize * lineStarts : 0;
+		long long count = horizontalCount + (size > 1 ? horizontalCount : 0);
+		if (size <= 0 || count == 0)
+		{
+			return false;
+		}
+
+		std::uniform_int_distribution<long long> pick(0, count - 1);
+		bool placed = false;
+		for (long long attempt = 0; attempt < MAX_SPARSE_ATTEMPTS && !placed; attempt++)
+		{
+			m_attempts++;
+			long long candidate = pick(random);
+			bool horizontal = candidate < horizontalCount;
+			long long index = horizontal ? candidate : candidate - horizontalCount;
+			int row = static_cast<int>(horizontal ? index / lineStarts : index / m_boardSize);
+			int col = static_cast<int>(horizontal ? index % lineStarts : index % m_boardSize);
+
+			WideCell start = WideCell::FromRowCol(row, col, m_boardSize);
+			if (board.PlaceShip(size, start, horizontal))
+			{
+				layout[ship] = Placement{ size, start, horizontal };
+				placed = true;
+			}
+		}
+		if (!placed)
+		{
+			return false;
+		}
+	}
+	return true;
+}
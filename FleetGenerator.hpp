@@ -0,0 +1,116 @@
+﻿#pragma once
+
+#include <vector>
+#include <random>
+#include "GameBoard.hpp"
+#include "BitBoard.hpp"
+#include "PlacementTables.hpp"
+#include "LayoutCountTable.hpp"
+
+// Генератор случайных расстановок флота, равномерных по всем допустимым
+// расстановкам. Если для поля и флота строится LayoutCountTable (поля до 10x10
+// со стандартным флотом, где флот помещается туго), расстановка выбирается
+// по ней за один проход по полю без повторных попыток: каждая позиция берется
+// с вероятностью, пропорциональной числу расстановок, которые ее продолжают,
+// а корабли одной длины получают выбранные позиции в случайном порядке.
+// Иначе позиции берутся из PlacementTables: корабли ставятся от длинных
+// к коротким, каждому берется случайная позиция из полного списка; если она
+// пересекает или касается уже поставленных, попытка начинается заново.
+// Любая допустимая упорядоченная расстановка получается с одной и той же
+// вероятностью 1 / (N1 * ... * Nk), поэтому принятые расстановки распределены
+// точно равномерно. Если за MAX_ATTEMPTS попыток расстановка не найдена,
+// Generate возвращает false.
+// Окрестность корабля задается правилом касания (по умолчанию корабли не
+// касаются). PlaceFleet(GameBoard&) принимает только поле с тем же правилом;
+// шаблонный PlaceFleet ставит флот на ядро поля набора правил
+// (RuleTraits<Rules>::CoreType).
+// На больших полях (GameBoard::IsSparseSize) флот слишком велик, чтобы
+// целая расстановка случайно подошла, а таблицы позиций - слишком велики
+// для памяти, поэтому корабли ставятся по одному прямо на поле, каждый
+// в случайную подходящую позицию; такое распределение уже не равномерно.
+class FleetGenerator
+{
+public:
+	static const long long MAX_ATTEMPTS = 1 << 16;
+	static const long long MAX_SPARSE_ATTEMPTS = 1 << 20;   // Попыток на один корабль большого поля
+
+	// Позиция одного корабля
+	struct Placement
+	{
+		int size;
+		WideCell start;
+		bool isHorizontal;
+	};
+
+	// публичные: переопределение типом
+	using LayoutType = std::vector<Placement>;  // В порядке размеров, переданных в конструктор
+	using WordType = BitBoard::WordType;
+	using Adjacency = PlacementTables::Adjacency;
+
+public:
+	// конструкторы и деконструктор
+	FleetGenerator(int boardSize, const GameBoard::ShipSizesType& shipSizes, Adjacency adjacency = Adjacency::eNoTouch);
+	~FleetGenerator() = default;
+
+	// публичные методы
+	bool Generate(std::mt19937& random, LayoutType& layout);
+	bool PlaceFleet(GameBoard& board, std::mt19937& random);
+
+	// Ядро поля с PlaceShip(size, row, col, isHorizontal), например RuleTraits<Rules>::CoreType
+	template <class CoreType>
+	bool PlaceFleet(CoreType& core, std::mt19937& random)
+	{
+		LayoutType layout;
+		if (core.GetSize() != m_boardSize || !Generate(random, layout))
+		{
+			return false;
+		}
+		for (const Placement& placement : layout)
+		{
+			if (!core.PlaceShip(placement.size, placement.start.GetRow(m_boardSize), placement.start.GetCol(m_boardSize), placement.isHorizontal))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// геттеры
+	int GetBoardSize() const { return m_boardSize; }
+	Adjacency GetAdjacency() const { return m_adjacency; }
+	const GameBoard::ShipSizesType& GetShipSizes() const { return m_shipSizes; }
+	long long GetAttempts() const { return m_attempts; }
+	bool IsCounted() const { return m_counts != nullptr; }   // Расстановки выбираются по LayoutCountTable
+
+private:
+	// Все позиции кораблей одной длины: горизонтальные, затем вертикальные
+	struct Candidates
+	{
+		const PlacementTables::Table* tables[2] = { nullptr, nullptr };
+		int count = 0;
+	};
+
+	// приватные методы
+	bool TryRandomLayout(std::mt19937& random);
+	void MakeCountedLayout(std::mt19937& random, LayoutType& layout);
+	static const PlacementTables::Table& Resolve(const Candidates& candidates, int& index);
+	bool Fits(const PlacementTables::Table& table, int index) const;
+	void Block(const PlacementTables::Table& table, int index);
+	void MakeLayout(LayoutType& layout) const;
+	bool PlaceSequentially(GameBoard& board, std::mt19937& random, LayoutType& layout);
+
+private:
+	// приватные переменные
+	int m_boardSize;
+	Adjacency m_adjacency;
+	bool m_sparse;
+	int m_wordCount;
+	GameBoard::ShipSizesType m_shipSizes;
+	std::vector<int> m_order;               // Корабли по убыванию длины
+	const LayoutCountTable* m_counts;       // nullptr - таблица не строится, расстановки подбираются попытками
+	std::vector<Candidates> m_candidates;   // По длине корабля
+	std::vector<WordType> m_blocked;        // Рабочие буферы текущей попытки
+	std::vector<int> m_picks;
+	LayoutCountTable::PicksType m_sampled;
+	long long m_attempts;                   // Попыток на последнюю расстановку
+};
@@ -0,0 +1,479 @@
+﻿#include "FleetSampler.hpp"
+#include <random>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+
+namespace
+{
+	// Одна цепь: текущая расстановка и счетчики соседства
+	class Chain
+	{
+	public:
+		Chain(const FleetSampler& sampler, std::uint64_t seed, int chainIndex)
+			: m_sampler(sampler)
+			, m_observation(sampler.GetObservation())
+			, m_size(m_observation.boardSize)
+			, m_halo(m_size * m_size, 0)
+			, m_isHit(m_size * m_size, 0)
+			, m_coveredHits(0)
+		{
+			std::seed_seq sequence{ static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32),
+				static_cast<std::uint32_t>(chainIndex) };
+			m_random.seed(sequence);
+
+			for (int cell : m_observation.hitCells)
+			{
+				m_isHit[cell] = 1;
+			}
+
+			// Сначала длинные корабли: их сложнее поставить при поиске начальной расстановки
+			m_lengths = m_observation.shipLengths;
+			std::sort(m_lengths.begin(), m_lengths.end(), std::greater<int>());
+			m_positions.assign(m_lengths.size(), FleetSampler::Placement{ -1, true });
+		}
+
+		// Прошлая расстановка подходит, если флот тот же и каждый корабль
+		// допустим при новом наблюдении
+		bool Restore(const FleetSampler::ChainState& state)
+		{
+			if (state.lengths != m_lengths || state.positions.size() != m_lengths.size())
+			{
+				return false;
+			}
+			for (size_t ship = 0; ship < m_lengths.size(); ship++)
+			{
+				if (!IsAllowed(m_lengths[ship], state.positions[ship]) || !Fits(m_lengths[ship], state.positions[ship]))
+				{
+					Clear();
+					return false;
+				}
+				Apply(static_cast<int>(ship), state.positions[ship], +1);
+			}
+			if (m_coveredHits != static_cast<int>(m_observation.hitCells.size()))
+			{
+				Clear();
+				return false;
+			}
+			return true;
+		}
+
+		void Save(FleetSampler::ChainState& state) const
+		{
+			state.lengths = m_lengths;
+			state.positions = m_positions;
+		}
+
+		// Случайный поиск с возвратом до первой согласованной расстановки
+		bool Initialize()
+		{
+			long long nodes = 0;
+			std::vector<std::uint8_t> placed(m_lengths.size(), 0);
+			return Search(placed, nodes);
+		}
+
+		void Sweep()
+		{
+			for (size_t i = 0; i < m_lengths.size(); i++)
+			{
+				if (m_lengths.size() >= 2 && m_random() % 4 == 0)
+				{
+					ProposeSwap();
+				}
+				else
+				{
+					ProposeMove();
+				}
+			}
+		}
+
+		void Accumulate(std::vector<int>& counts) const
+		{
+			for (size_t ship = 0; ship < m_lengths.size(); ship++)
+			{
+				for (int i = 0; i < m_lengths[ship]; i++)
+				{
+					int cell = Cell(m_positions[ship], i);
+					if (!m_isHit[cell])
+					{
+						counts[cell]++;
+					}
+				}
+			}
+		}
+
+	private:
+		void Clear()
+		{
+			std::fill(m_halo.begin(), m_halo.end(), 0);
+			std::fill(m_positions.begin(), m_positions.end(), FleetSampler::Placement{ -1, true });
+			m_coveredHits = 0;
+		}
+
+		int Cell(const FleetSampler::Placement& placement, int i) const
+		{
+			return placement.start + (placement.horizontal ? i : i * m_size);
+		}
+
+		int HitsIn(int length, const FleetSampler::Placement& placement) const
+		{
+			int hits = 0;
+			for (int i = 0; i < length; i++)
+			{
+				hits += m_isHit[Cell(placement, i)];
+			}
+			return hits;
+		}
+
+		// Корабль в пределах поля, только на разрешенных клетках и не целиком
+		// на попаданиях (такой корабль уже был бы потоплен)
+		bool IsAllowed(int length, const FleetSampler::Placement& placement) const
+		{
+			int row = placement.start / m_size;
+			int col = placement.start % m_size;
+			if ((placement.horizontal ? col : row) + length > m_size)
+			{
+				return false;
+			}
+			for (int i = 0; i < length; i++)
+			{
+				if (!m_observation.allowedCells[Cell(placement, i)])
+				{
+					return false;
+				}
+			}
+			return HitsIn(length, placement) < length;
+		}
+
+		// Клетки корабля не лежат в окрестности других кораблей
+		bool Fits(int length, const FleetSampler::Placement& placement) const
+		{
+			for (int i = 0; i < length; i++)
+			{
+				if (m_halo[Cell(placement, i)] != 0)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		void Apply(int ship, const FleetSampler::Placement& placement, int delta)
+		{
+			int length = m_lengths[ship];
+			int row = placement.start / m_size;
+			int col = placement.start % m_size;
+			int endRow = placement.horizontal ? row : row + length - 1;
+			int endCol = placement.horizontal ? col + length - 1 : col;
+
+			for (int r = std::max(row - 1, 0); r <= std::min(endRow + 1, m_size - 1); r++)
+			{
+				for (int c = std::max(col - 1, 0); c <= std::min(endCol + 1, m_size - 1); c++)
+				{
+					m_halo[r * m_size + c] = static_cast<std::uint8_t>(m_halo[r * m_size + c] + delta);
+				}
+			}
+
+			m_coveredHits += delta * HitsIn(length, placement);
+			m_positions[ship] = delta > 0 ? placement : FleetSampler::Placement{ -1, true };
+		}
+
+		bool Search(std::vector<std::uint8_t>& placed, long long& nodes)
+		{
+			if (++nodes > FleetSampler::MAX_SEARCH_NODES)
+			{
+				return false;
+			}
+
+			// Первое ненакрытое попадание должен накрыть один из оставшихся кораблей
+			int uncovered = -1;
+			for (int cell : m_observation.hitCells)
+			{
+				if (m_halo[cell] == 0 || !IsCovered(cell))
+				{
+					uncovered = cell;
+					break;
+				}
+			}
+
+			std::vector<std::pair<int, FleetSampler::Placement>> options;
+			if (uncovered >= 0)
+			{
+				int lastLength = -1;
+				for (size_t ship = 0; ship < m_lengths.size(); ship++)
+				{
+					// Одинаковые корабли взаимозаменяемы, пробуем первый свободный каждой длины
+					if (placed[ship] || m_lengths[ship] == lastLength)
+					{
+						continue;
+					}
+					lastLength = m_lengths[ship];
+					for (int i = 0; i < m_lengths[ship]; i++)
+					{
+						for (bool horizontal : { true, false })
+						{
+							int start = horizontal ? uncovered - i : uncovered - i * m_size;
+							if (start < 0 || (horizontal && start / m_size != uncovered / m_size))
+							{
+								continue;
+							}
+							options.push_back({ static_cast<int>(ship), FleetSampler::Placement{ start, horizontal } });
+						}
+					}
+				}
+			}
+			else
+			{
+				auto next = std::find(placed.begin(), placed.end(), 0);
+				if (next == placed.end())
+				{
+					return m_coveredHits == static_cast<int>(m_observation.hitCells.size());
+				}
+
+				int ship = static_cast<int>(next - placed.begin());
+				for (const auto& candidate : m_sampler.GetCandidates(m_lengths[ship]))
+				{
+					options.push_back({ ship, candidate });
+				}
+			}
+
+			std::shuffle(options.begin(), options.end(), m_random);
+			for (const auto& option : options)
+			{
+				int ship = option.first;
+				if (!IsAllowed(m_lengths[ship], option.second) || !Fits(m_lengths[ship], option.second))
+				{
+					continue;
+				}
+
+				Apply(ship, option.second, +1);
+				placed[ship] = 1;
+				if (Search(placed, nodes))
+				{
+					return true;
+				}
+				placed[ship] = 0;
+				Apply(ship, option.second, -1);
+			}
+			return false;
+		}
+
+		bool IsCovered(int cell) const
+		{
+			for (size_t ship = 0; ship < m_lengths.size(); ship++)
+			{
+				if (m_positions[ship].start < 0)
+				{
+					continue;
+				}
+				for (int i = 0; i < m_lengths[ship]; i++)
+				{
+					if (Cell(m_positions[ship], i) == cell)
+					{
+						return true;
+					}
+				}
+			}
+			return false;
+		}
+
+		void ProposeMove()
+		{
+			int ship = m_random() % m_lengths.size();
+			const auto& candidates = m_sampler.GetCandidates(m_lengths[ship]);
+			FleetSampler::Placement current = m_positions[ship];
+			FleetSampler::Placement proposal = candidates[m_random() % candidates.size()];
+
+			Apply(ship, current, -1);
+			int required = static_cast<int>(m_observation.hitCells.size()) - m_coveredHits;
+			if (Fits(m_lengths[ship], proposal) && HitsIn(m_lengths[ship], proposal) == required)
+			{
+				Apply(ship, proposal, +1);
+			}
+			else
+			{
+				Apply(ship, current, +1);
+			}
+		}
+
+		void ProposeSwap()
+		{
+			int first = m_random() % m_lengths.size();
+			int second = m_random() % m_lengths.size();
+			if (m_lengths[first] == m_lengths[second])
+			{
+				return;
+			}
+
+			FleetSampler::Placement firstPosition = m_positions[first];
+			FleetSampler::Placement secondPosition = m_positions[second];
+			Apply(first, firstPosition, -1);
+			Apply(second, secondPosition, -1);
+
+			int required = static_cast<int>(m_observation.hitCells.size()) - m_coveredHits;
+			bool valid = IsAllowed(m_lengths[first], secondPosition) && IsAllowed(m_lengths[second], firstPosition)
+				&& Fits(m_lengths[first], secondPosition)
+				&& HitsIn(m_lengths[first], secondPosition) + HitsIn(m_lengths[second], firstPosition) == required;
+			if (valid)
+			{
+				Apply(first, secondPosition, +1);
+				valid = Fits(m_lengths[second], firstPosition);
+				if (valid)
+				{
+					Apply(second, firstPosition, +1);
+					return;
+				}
+				Apply(first, secondPosition, -1);
+			}
+
+			Apply(first, firstPosition, +1);
+			Apply(second, secondPosition, +1);
+		}
+
+	private:
+		const FleetSampler& m_sampler;
+		const FleetSampler::Observation& m_observation;
+		int m_size;
+		std::mt19937 m_random;
+		std::vector<int> m_lengths;
+		std::vector<FleetSampler::Placement> m_positions;
+		std::vector<std::uint8_t> m_halo;    // Сколько кораблей (с окрестностью) накрывают клетку
+		std::vector<std::uint8_t> m_isHit;
+		int m_coveredHits;
+	};
+}
+
+FleetSampler::FleetSampler(const Observation& observation)
+	: m_observation(observation)
+	, m_maxLength(0)
+{
+	for (int length : m_observation.shipLengths)
+	{
+		m_maxLength = std::max(m_maxLength, length);
+	}
+
+	// Позиции, где корабль стоит только на разрешенных клетках и не целиком на попаданиях
+	int size = m_observation.boardSize;
+	m_candidates.resize(m_maxLength + 1);
+	for (int length = 1; length <= m_maxLength; length++)
+	{
+		for (bool horizontal : { true, false })
+		{
+			if (length == 1 && !horizontal)
+			{
+				continue;
+			}
+
+			for (int row = 0; row + (horizontal ? 0 : length - 1) < size; row++)
+			{
+				for (int col = 0; col + (horizontal ? length - 1 : 0) < size; col++)
+				{
+					bool allowed = true;
+					int hits = 0;
+					for (int i = 0; i < length && allowed; i++)
+					{
+						int cell = horizontal ? row * size + col + i : (row + i) * size + col;
+						allowed = m_observation.allowedCells[cell] != 0;
+						hits += static_cast<int>(std::count(m_observation.hitCells.begin(), m_observation.hitCells.end(), cell));
+					}
+					if (allowed && hits < length)
+					{
+						m_candidates[length].push_back(Placement{ row * size + col, horizontal });
+					}
+				}
+			}
+		}
+	}
+}
+
+FleetSampler::Result FleetSampler::Run(long long samplesPerChain, int chainCount, int threadCount, std::uint64_t seed,
+	ChainStatesType* chainStates) const
+{
+	Result result;
+	int cellCount = m_observation.boardSize * m_observation.boardSize;
+	result.hitCounts.assign(cellCount, 0);
+
+	// Для каждого корабля должна найтись хотя бы одна позиция
+	for (int length : m_observation.shipLengths)
+	{
+		if (length <= 0 || length > m_maxLength || m_candidates[length].empty())
+		{
+			return result;
+		}
+	}
+	if (m_observation.shipLengths.empty() || chainCount <= 0 || samplesPerChain <= 0)
+	{
+		return result;
+	}
+
+	threadCount = std::max(1, std::min(threadCount, chainCount));
+	std::vector<std::vector<int>> threadCounts(threadCount, std::vector<int>(cellCount, 0));
+	std::vector<long long> threadSamples(threadCount, 0);
+	std::vector<int> threadWarmChains(threadCount, 0);
+	if (chainStates)
+	{
+		chainStates->resize(chainCount);
+	}
+
+	auto worker = [&](int thread)
+	{
+		for (int chainIndex = thread; chainIndex < chainCount; chainIndex += threadCount)
+		{
+			Chain chain(*this, seed, chainIndex);
+			if (chainStates && chain.Restore((*chainStates)[chainIndex]))
+			{
+				threadWarmChains[thread]++;
+			}
+			else if (chain.Initialize())
+			{
+				for (int sweep = 0; sweep < BURN_IN_SWEEPS; sweep++)
+				{
+					chain.Sweep();
+				}
+			}
+			else
+			{
+				continue;
+			}
+
+			for (long long sample = 0; sample < samplesPerChain; sample++)
+			{
+				for (int sweep = 0; sweep < SWEEPS_PER_SAMPLE; sweep++)
+				{
+					chain.Sweep();
+				}
+				chain.Accumulate(threadCounts[thread]);
+			}
+			threadSamples[thread] += samplesPerChain;
+			if (chainStates)
+			{
+				chain.Save((*chainStates)[chainIndex]);
+			}
+		}
+	};
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> threads;
+	for (int thread = 1; thread < threadCount; thread++)
+	{
+		threads.emplace_back(worker, thread);
+	}
+	worker(0);
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+	result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	// Суммирование в фиксированном порядке - итог не зависит от числа потоков
+	for (int thread = 0; thread < threadCount; thread++)
+	{
+		for (int cell = 0; cell < cellCount; cell++)
+		{
+			result.hitCounts[cell] += threadCounts[thread][cell];
+		}
+		result.samples += threadSamples[thread];
+		result.warmChains += threadWarmChains[thread];
+	}
+	return result;
+}
@@ -0,0 +1,82 @@
+﻿#pragma once
+
+#include <vector>
+#include <cstdint>
+
+// Марковская цепь по расстановкам оставшегося флота, согласованным с
+// наблюдениями ИИ. Состояние цепи - полная расстановка: корабли стоят
+// только на неизвестных клетках и попаданиях, не пересекаются и не
+// касаются друг друга (как в GameBoard::PlaceShip), накрывают все
+// незавершенные попадания и не стоят целиком на попаданиях. Предложения - перенос корабля на случайную
+// позицию и обмен позициями двух кораблей разной длины; оба симметричны,
+// поэтому принимается любое допустимое предложение, и цепь сходится к
+// равномерному распределению по согласованным расстановкам.
+// Run может продолжить цепи с расстановок прошлого запуска (ChainState).
+// Новое наблюдение только добавляет условие (промах или попадание), поэтому
+// прежняя расстановка, которая ему не противоречит, уже распределена как
+// нужно: такая цепь пропускает поиск начальной расстановки и прогрев.
+// Противоречащая или сделанная для другого флота расстановка начинается заново.
+class FleetSampler
+{
+public:
+	static const int BURN_IN_SWEEPS = 20;          // Проходов по флоту до первой выборки
+	static const int SWEEPS_PER_SAMPLE = 2;        // Проходов по флоту между выборками
+	static const long long MAX_SEARCH_NODES = 200000;
+
+	// Позиция корабля на поле
+	struct Placement
+	{
+		int start;
+		bool horizontal;
+	};
+
+	// Что известно о поле противника
+	struct Observation
+	{
+		int boardSize = 0;
+		std::vector<std::uint8_t> allowedCells;  // 1 - здесь может стоять корабль
+		std::vector<int> hitCells;               // Незавершенные попадания
+		std::vector<int> shipLengths;            // Непотопленные корабли
+	};
+
+	// Последняя расстановка цепи для следующего запуска
+	struct ChainState
+	{
+		std::vector<int> lengths;         // Корабли по убыванию длины
+		std::vector<Placement> positions;
+	};
+
+	// Итог выборки
+	struct Result
+	{
+		std::vector<int> hitCounts;  // Сколько выборок поставили корабль в клетку
+		long long samples = 0;
+		int warmChains = 0;          // Цепей, продолженных с прошлой расстановки
+		double seconds = 0.0;
+
+		double GetSamplesPerSecond() const { return seconds > 0 ? samples / seconds : 0.0; }
+	};
+
+	// публичные: переопределение типом
+	using PlacementsType = std::vector<Placement>;
+	using ChainStatesType = std::vector<ChainState>;   // [номер цепи]
+
+public:
+	// конструкторы и деконструктор
+	FleetSampler(const Observation& observation);
+	~FleetSampler() = default;
+
+	// публичные методы
+	Result Run(long long samplesPerChain, int chainCount, int threadCount, std::uint64_t seed,
+		ChainStatesType* chainStates = nullptr) const;
+
+	// геттеры
+	const Observation& GetObservation() const { return m_observation; }
+	const PlacementsType& GetCandidates(int length) const { return m_candidates[length]; }
+
+private:
+	// приватные переменные
+	Observation m_observation;
+	int m_maxLength;
+	std::vector<PlacementsType> m_candidates;  // Допустимые позиции по длине корабля
+};
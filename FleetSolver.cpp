@@ -0,0 +1,383 @@
+﻿#include "FleetSolver.hpp"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+namespace
+{
+	// Жадная расстановка хранит поле целиком; больше этого - только без нее
+	const long long MAX_GREEDY_CELLS = 1LL << 26;
+}
+
+FleetSolver::FleetSolver(int boardSize, const ShipSizesType& shipSizes, PlacementTables::Adjacency adjacency)
+	: m_boardSize(boardSize)
+	, m_shipSizes(shipSizes)
+	, m_adjacency(adjacency)
+	, m_aborted(false)
+	, m_saturated(false)
+{
+	ShipSizesType sorted = shipSizes;
+	std::sort(sorted.begin(), sorted.end(), std::greater<int>());
+	for (int size : sorted)
+	{
+		if (m_lengths.empty() || m_lengths.back() != size)
+		{
+			m_lengths.push_back(size);
+			m_lengthCounts.push_back(0);
+		}
+		m_lengthCounts.back()++;
+	}
+}
+
+FleetSolver::Result FleetSolver::Solve(bool countLayouts)
+{
+	Result result;
+	m_memo.clear();
+	m_aborted = false;
+	m_saturated = false;
+
+	// Корабль длиннее поля не ставится никуда
+	for (int length : m_lengths)
+	{
+		if (length < 1 || length > m_boardSize)
+		{
+			result.feasibility = Feasibility::eInfeasible;
+			result.counted = countLayouts;
+			return result;
+		}
+	}
+
+	bool placed = PlaceShelves() || PlaceGreedy();
+	if (placed)
+	{
+		result.feasibility = Feasibility::eFeasible;
+	}
+
+	if (CanSearch() && (countLayouts || !placed))
+	{
+		std::uint64_t counts = 0;
+		for (size_t i = 0; i < m_lengths.size(); i++)
+		{
+			counts |= static_cast<std::uint64_t>(m_lengthCounts[i]) << (i * COUNT_BITS);
+		}
+
+		std::uint64_t layouts = Count(0, Window{}, counts, !countLayouts);
+		result.states = static_cast<long long>(m_memo.size());
+		if (layouts > 0)
+		{
+			result.feasibility = Feasibility::eFeasible;
+		}
+		else if (!m_aborted)
+		{
+			result.feasibility = Feasibility::eInfeasible;
+		}
+
+		if (countLayouts && !m_aborted)
+		{
+			result.counted = true;
+			result.saturated = m_saturated;
+			result.layoutCount = layouts;
+		}
+	}
+	m_memo.clear();
+	return result;
+}
+
+FleetSolver::Result FleetSolver::SolveCached(bool countLayouts, const std::string& cachePath)
+{
+	// Строка кэша: ключ, возможность, посчитано ли, переполнение, число расстановок
+	std::string key = MakeCacheKey();
+	std::ifstream input(cachePath);
+	std::string line;
+	bool known = false;
+	while (std::getline(input, line))
+	{
+		std::istringstream fields(line);
+		std::string lineKey;
+		int feasibility = 0;
+		Result cached;
+		if (fields >> lineKey >> feasibility >> cached.counted >> cached.saturated >> cached.layoutCount && lineKey == key)
+		{
+			cached.feasibility = static_cast<Feasibility>(feasibility);
+			if (cached.counted || !countLayouts)
+			{
+				return cached;
+			}
+			known = true;
+		}
+	}
+	input.close();
+
+	// Без посчитанного числа новая строка ничего не добавила бы к уже записанной
+	Result result = Solve(countLayouts);
+	if (result.feasibility != Feasibility::eUnknown && (result.counted || !known))
+	{
+		std::ofstream output(cachePath, std::ios::app);
+		output << key << " " << static_cast<int>(result.feasibility) << " " << result.counted << " "
+			<< result.saturated << " " << result.layoutCount << "\n";
+	}
+	return result;
+}
+
+std::string FleetSolver::MakeCacheKey() const
+{
+	std::ostringstream key;
+	key << m_boardSize << "/" << static_cast<int>(m_adjacency) << "/";
+	for (size_t i = 0; i < m_lengths.size(); i++)
+	{
+		key << (i > 0 ? "," : "") << m_lengths[i] << "x" << m_lengthCounts[i];
+	}
+	return key.str();
+}
+
+size_t FleetSolver::StateHash::operator()(const StateKey& key) const
+{
+	std::uint64_t hash = key.window.low * 0x9E3779B97F4A7C15ull;
+	hash ^= (key.window.high + 0x632BE59BD9B4E019ull) * 0xBF58476D1CE4E5B9ull;
+	hash ^= (key.counts + static_cast<std::uint64_t>(key.cell) * 0x94D049BB133111EBull) * 0xD6E8FEB86659FD93ull;
+	return static_cast<size_t>(hash ^ (hash >> 29));
+}
+
+bool FleetSolver::PlaceShelves() const
+{
+	// Корабли кладутся горизонтально через ряд и через клетку друг от друга,
+	// поэтому не касаются ни при каком правиле; ряды считаются, а не строятся
+	long long row = 0;
+	long long col = 0;
+	for (size_t i = 0; i < m_lengths.size(); i++)
+	{
+		long long length = m_lengths[i];
+		long long remaining = m_lengthCounts[i];
+		while (remaining > 0)
+		{
+			long long fit = col + length <= m_boardSize ? (m_boardSize - col + 1) / (length + 1) : 0;
+			long long taken = std::min(fit, remaining);
+			remaining -= taken;
+			col += taken * (length + 1);
+			if (remaining > 0)
+			{
+				row += 2;
+				col = 0;
+				if (row >= m_boardSize)
+				{
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+bool FleetSolver::PlaceGreedy() const
+{
+	long long cellCount = static_cast<long long>(m_boardSize) * m_boardSize;
+	if (cellCount > MAX_GREEDY_CELLS)
+	{
+		return false;
+	}
+
+	std::vector<bool> occupied(static_cast<size_t>(cellCount), false);
+	auto fits = [&](long long start, int length, bool horizontal)
+	{
+		int row = static_cast<int>(start / m_boardSize);
+		int col = static_cast<int>(start % m_boardSize);
+		int endRow = horizontal ? row : row + length - 1;
+		int endCol = horizontal ? col + length - 1 : col;
+		if (endRow >= m_boardSize || endCol >= m_boardSize)
+		{
+			return false;
+		}
+		for (int r = std::max(row - 1, 0); r <= std::min(endRow + 1, m_boardSize - 1); r++)
+		{
+			for (int c = std::max(col - 1, 0); c <= std::min(endCol + 1, m_boardSize - 1); c++)
+			{
+				if (occupied[static_cast<size_t>(r) * m_boardSize + c] &&
+					PlacementTables::IsInHalo(m_adjacency, r, c, row, col, endRow, endCol))
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	};
+
+	// Занятые клетки только добавляются, поэтому позиция, не подошедшая кораблю
+	// этой длины, не подойдет и следующему - поиск продолжается с того же места
+	for (size_t i = 0; i < m_lengths.size(); i++)
+	{
+		int length = m_lengths[i];
+		long long start = 0;
+		for (int ship = 0; ship < m_lengthCounts[i]; ship++)
+		{
+			bool horizontal = true;
+			while (start < cellCount)
+			{
+				if (fits(start, length, true))
+				{
+					horizontal = true;
+					break;
+				}
+				if (length > 1 && fits(start, length, false))
+				{
+					horizontal = false;
+					break;
+				}
+				start++;
+			}
+			if (start >= cellCount)
+			{
+				return false;
+			}
+
+			for (int k = 0; k < length; k++)
+			{
+				occupied[static_cast<size_t>(start + (horizontal ? k : static_cast<long long>(k) * m_boardSize))] = true;
+			}
+		}
+	}
+	return true;
+}
+
+bool FleetSolver::CanSearch() const
+{
+	if (m_lengths.empty() || static_cast<int>(m_lengths.size()) > MAX_LENGTHS)
+	{
+		return false;
+	}
+	for (int count : m_lengthCounts)
+	{
+		if (count >= (1 << COUNT_BITS))
+		{
+			return false;
+		}
+	}
+
+	// Дальняя клетка, которую задевает корабль с окрестностью от текущей клетки
+	int reach = m_lengths.front() * m_boardSize + m_lengths.front();
+	return reach < WINDOW_BITS;
+}
+
+std::uint64_t FleetSolver::Count(int cell, Window window, std::uint64_t counts, bool stopAtFirst)
+{
+	if (counts == 0)
+	{
+		return 1;
+	}
+
+	// Занятые клетки пропускаются: в них ничего не ставится
+	int cellCount = m_boardSize * m_boardSize;
+	while (cell < cellCount && window.Test(0))
+	{
+		window.Shift();
+		cell++;
+	}
+
+	int shipCells = 0;
+	for (size_t i = 0; i < m_lengths.size(); i++)
+	{
+		shipCells += m_lengths[i] * static_cast<int>((counts >> (i * COUNT_BITS)) & ((1 << COUNT_BITS) - 1));
+	}
+	if (shipCells > cellCount - cell)
+	{
+		return 0;
+	}
+
+	StateKey key{ cell, counts, window };
+	auto found = m_memo.find(key);
+	if (found != m_memo.end())
+	{
+		return found->second;
+	}
+	if (static_cast<long long>(m_memo.size()) >= MAX_STATES)
+	{
+		m_aborted = true;
+		return 0;
+	}
+
+	// Текущая клетка - начало корабля одной из оставшихся длин...
+	std::uint64_t total = 0;
+	for (size_t i = 0; i < m_lengths.size(); i++)
+	{
+		std::uint64_t one = std::uint64_t(1) << (i * COUNT_BITS);
+		if ((counts >> (i * COUNT_BITS) & ((1 << COUNT_BITS) - 1)) == 0)
+		{
+			continue;
+		}
+		for (bool horizontal : { true, false })
+		{
+			Window next = window;
+			if ((horizontal || m_lengths[i] > 1) && TryPlace(cell, m_lengths[i], horizontal, next))
+			{
+				next.Shift();
+				total = AddSaturated(total, Count(cell + 1, next, counts - one, stopAtFirst), m_saturated);
+				if (stopAtFirst && total > 0)
+				{
+					return total;
+				}
+			}
+		}
+	}
+
+	// ...или остается пустой
+	Window next = window;
+	next.Shift();
+	total = AddSaturated(total, Count(cell + 1, next, counts, stopAtFirst), m_saturated);
+	if (stopAtFirst && total > 0)
+	{
+		return total;
+	}
+
+	// Прерванный перебор не дает точного числа, такое состояние не запоминается
+	if (!m_aborted)
+	{
+		m_memo.emplace(key, total);
+	}
+	return total;
+}
+
+bool FleetSolver::TryPlace(int cell, int length, bool horizontal, Window& window) const
+{
+	int row = cell / m_boardSize;
+	int col = cell % m_boardSize;
+	int endRow = horizontal ? row : row + length - 1;
+	int endCol = horizontal ? col + length - 1 : col;
+	if (endRow >= m_boardSize || endCol >= m_boardSize)
+	{
+		return false;
+	}
+
+	int step = horizontal ? 1 : m_boardSize;
+	for (int k = 0; k < length; k++)
+	{
+		if (window.Test(k * step))
+		{
+			return false;
+		}
+	}
+
+	// Окрестность закрывается только впереди: клетки до текущей уже решены
+	for (int r = row; r <= std::min(endRow + 1, m_boardSize - 1); r++)
+	{
+		for (int c = std::max(col - 1, 0); c <= std::min(endCol + 1, m_boardSize - 1); c++)
+		{
+			int offset = r * m_boardSize + c - cell;
+			if (offset >= 0 && PlacementTables::IsInHalo(m_adjacency, r, c, row, col, endRow, endCol))
+			{
+				window.Set(offset);
+			}
+		}
+	}
+	return true;
+}
+
+std::uint64_t FleetSolver::AddSaturated(std::uint64_t left, std::uint64_t right, bool& saturated)
+{
+	if (left > std::numeric_limits<std::uint64_t>::max() - right)
+	{
+		saturated = true;
+		return std::numeric_limits<std::uint64_t>::max();
+	}
+	return left + right;
+}
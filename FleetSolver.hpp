@@ -0,0 +1,110 @@
+﻿#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+#include "GameBoard.hpp"
+#include "PlacementTables.hpp"
+
+// Помещается ли флот на поле и сколькими способами. Клетки перебираются
+// по порядку, и каждая либо остается пустой, либо становится левым верхним
+// концом корабля одной из оставшихся длин - так каждая расстановка (корабли
+// одной длины неразличимы) строится ровно один раз. Клетки до текущей уже
+// решены, а корабль с окрестностью достает не дальше чем на
+// (длина + 1) рядов вперед, поэтому состояние - номер клетки, окно занятых
+// клеток перед ней и оставшиеся корабли - запоминается вместе с числом
+// расстановок (динамика по профилю). Если окно не помещается в 128 бит или
+// состояний больше MAX_STATES, число не считается, а возможность расстановки
+// подтверждает укладка рядами (через ряд и через клетку, считается без поля,
+// поэтому годится и для очень больших полей) или жадная расстановка (от
+// длинных к коротким, в первую свободную позицию).
+// Результаты сохраняются в текстовом файле: по строке на поле и флот.
+class FleetSolver
+{
+public:
+	static const long long MAX_STATES = 1 << 22;
+	static const int WINDOW_BITS = 128;
+	static const int COUNT_BITS = 6;     // На число кораблей одной длины в ключе состояния
+	static const int MAX_LENGTHS = 64 / COUNT_BITS;
+	static constexpr const char* DEFAULT_CACHE_PATH = "battleship_fleets.cache";
+
+	enum class Feasibility
+	{
+		eFeasible = 0,
+		eInfeasible = 1,
+		eUnknown = 2     // Жадная расстановка не нашлась, а полный перебор слишком велик
+	};
+
+	// Итог решения
+	struct Result
+	{
+		Feasibility feasibility = Feasibility::eUnknown;
+		bool counted = false;                 // layoutCount посчитан полным перебором
+		bool saturated = false;               // Расстановок больше, чем помещается в 64 бита
+		std::uint64_t layoutCount = 0;
+		long long states = 0;
+	};
+
+	// публичные: переопределение типом
+	using ShipSizesType = GameBoard::ShipSizesType;
+
+public:
+	// конструкторы и деконструктор
+	FleetSolver(int boardSize, const ShipSizesType& shipSizes,
+		PlacementTables::Adjacency adjacency = PlacementTables::Adjacency::eNoTouch);
+	~FleetSolver() = default;
+
+	// публичные методы
+	Result Solve(bool countLayouts);
+	Result SolveCached(bool countLayouts, const std::string& cachePath = DEFAULT_CACHE_PATH);
+	std::string MakeCacheKey() const;
+
+private:
+	// Занятые клетки начиная с текущей: бит 0 - текущая клетка
+	struct Window
+	{
+		std::uint64_t low = 0;
+		std::uint64_t high = 0;
+
+		bool Test(int bit) const { return bit < 64 ? (low >> bit) & 1 : (high >> (bit - 64)) & 1; }
+		void Set(int bit) { (bit < 64 ? low : high) |= std::uint64_t(1) << (bit & 63); }
+		void Shift() { low = (low >> 1) | (high << 63); high >>= 1; }
+	};
+
+	// Состояние перебора
+	struct StateKey
+	{
+		int cell;
+		std::uint64_t counts;
+		Window window;
+
+		bool operator==(const StateKey& other) const
+		{
+			return cell == other.cell && counts == other.counts && window.low == other.window.low && window.high == other.window.high;
+		}
+	};
+	struct StateHash
+	{
+		size_t operator()(const StateKey& key) const;
+	};
+
+	// приватные методы
+	bool PlaceShelves() const;
+	bool PlaceGreedy() const;
+	bool CanSearch() const;
+	std::uint64_t Count(int cell, Window window, std::uint64_t counts, bool stopAtFirst);
+	bool TryPlace(int cell, int length, bool horizontal, Window& window) const;
+	static std::uint64_t AddSaturated(std::uint64_t left, std::uint64_t right, bool& saturated);
+
+private:
+	// приватные переменные
+	int m_boardSize;
+	ShipSizesType m_shipSizes;
+	PlacementTables::Adjacency m_adjacency;
+	std::vector<int> m_lengths;               // Разные длины флота по убыванию
+	std::vector<int> m_lengthCounts;          // Кораблей каждой длины
+	std::unordered_map<StateKey, std::uint64_t, StateHash> m_memo;
+	bool m_aborted;
+	bool m_saturated;
+};
@@ -1,128 +1,218 @@
 ﻿#include "GameBoard.hpp"
 #include <algorithm>
+#include <stdexcept>
+#include <cassert>
 
-GameBoard::GameBoard(int size)
+static_assert(GameBoard::DEFAULT_BOARD_SIZE == RussianRules::BOARD_SIZE, "Стандартное поле - поле русских правил");
+static_assert(GameBoard::MAX_DENSE_BOARD_SIZE <= Cell::MAX_BOARD_SIZE, "Клетка плотного поля должна помещаться в 16-битную Cell");
+
+GameBoard::GameBoard(int size, Adjacency adjacency)
 	: m_size(size)
+	, m_adjacency(adjacency)
+	, m_core(MakeCore(size, adjacency))
 {
 }
 
-bool GameBoard::PlaceShip(const Ship& ship)
+GameBoard::CoreType GameBoard::MakeCore(int size, Adjacency adjacency)
 {
-	// Проверка на выход за границы
-	for (const auto& coord : ship.GetCoordinates())
+	// Поля с касанием - редкий случай: одно ядро любого размера на каждое правило
+	if (adjacency != RussianRules::ADJACENCY)
 	{
-		if (coord.first < 0 || coord.first >= m_size ||
-			coord.second < 0 || coord.second >= m_size)
+		if (size > MAX_BOARD_SIZE || IsSparseSize(size))
+		{
+			throw std::invalid_argument("Правила с касанием доступны только на полях до GameBoard::MAX_DENSE_BOARD_SIZE");
+		}
+		if (adjacency == Adjacency::eTouch)
 		{
-			return false;
+			return BoardCore<0, Adjacency::eTouch>(size);
 		}
+		return BoardCore<0, Adjacency::eDiagonal>(size);
 	}
 
-	// Проверка на пересечение с другими кораблями
-	for (const auto& existingShip : m_ships)
+	switch (size)
 	{
-		for (const auto& existingCoord : existingShip.GetCoordinates())
+	case 8:
+		return BoardCore<8>();
+	case 10:
+		return BoardCore<10>();
+	case 12:
+		return BoardCore<12>();
+	case 16:
+		return BoardCore<16>();
+	default:
+		// Индекс клетки должен помещаться в WideCell
+		if (size > MAX_BOARD_SIZE)
 		{
-			for (const auto& newCoord : ship.GetCoordinates())
-			{
-				// Проверка самой координаты и соседних клеток
-				for (int i = -1; i <= 1; i++)
-				{
-					for (int j = -1; j <= 1; j++)
-					{
-						if (existingCoord.first + i == newCoord.first &&
-							existingCoord.second + j == newCoord.second)
-						{
-							return false;
-						}
-					}
-				}
-			}
+			throw std::invalid_argument("Размер поля больше GameBoard::MAX_BOARD_SIZE");
+		}
+		if (IsSparseSize(size))
+		{
+			return SparseBoardCore(size);
 		}
+		return BoardCore<0>(size);
 	}
-
-	m_ships.push_back(ship);
-	return true;
 }
 
-Ship::ShotResult GameBoard::ReceiveShot(std::pair<int, int> coord)
+bool GameBoard::CanPlaceShip(int size, WideCell start, bool isHorizontal) const
 {
-	// Проверка на повторный выстрел
-	if (m_shots.find(coord) != m_shots.end())
+	// Ряд и столбец нужны ядру, чтобы проверить, что корабль не выходит за край
+	if (!start.IsValid() || start.GetIndex() >= m_size * m_size)
 	{
-		return Ship::ShotResult::eAlreadyShot;
+		return false;
 	}
+	return std::visit([&](const auto& core) { return core.CanPlaceShip(size, start.GetRow(m_size), start.GetCol(m_size), isHorizontal); }, m_core);
+}
 
-	m_shots.insert(coord);
-
-	// Проверка попадания
-	for (auto& ship : m_ships)
+bool GameBoard::PlaceShip(int size, WideCell start, bool isHorizontal)
+{
+	if (!start.IsValid() || start.GetIndex() >= m_size * m_size)
 	{
-		if (ship.TakeHit(coord))
-		{
-			if (ship.IsSunk())
-			{
-				return Ship::ShotResult::eSunk;
-			}
-			return Ship::ShotResult::eHit;
-		}
+		return false;
 	}
+	return std::visit([&](auto& core) { return core.PlaceShip(size, start.GetRow(m_size), start.GetCol(m_size), isHorizontal); }, m_core);
+}
 
-	m_misses.push_back(coord);
-	return Ship::ShotResult::eMiss;
+bool GameBoard::PlaceShip(const Ship& ship)
+{
+	return PlaceShip(ship.GetSize(), ship.GetStart(), ship.GetIsHorizontal());
 }
 
-bool GameBoard::IsAllShipsSunk() const
+Ship::ShotResult GameBoard::ReceiveShot(WideCell cell)
 {
-	for (const auto& ship : m_ships)
+	return std::visit([&](auto& core) { return core.ReceiveShot(cell.GetIndex()); }, m_core);
+}
+
+void GameBoard::ReceiveShots(std::span<const Cell> cells, std::span<Ship::ShotResult> results)
+{
+	ReceiveSalvo(cells, results);
+}
+
+void GameBoard::ReceiveShots(std::span<const WideCell> cells, std::span<Ship::ShotResult> results)
+{
+	ReceiveSalvo(cells, results);
+}
+
+template <class CellType>
+void GameBoard::ReceiveSalvo(std::span<const CellType> cells, std::span<Ship::ShotResult> results)
+{
+	// Один выбор специализации на весь залп
+	if (results.size() < cells.size())
 	{
-		if (!ship.IsSunk())
-		{
-			return false;
-		}
+		throw std::invalid_argument("Буфер результатов меньше залпа");
 	}
-	return true;
+	std::visit([&](auto& core) { core.ReceiveShots(cells, results); }, m_core);
 }
 
-GameBoard::BoardStateType GameBoard::GetVisibleState(bool forOwner) const
+GameBoard::UndoType GameBoard::ApplyShot(WideCell cell)
 {
-	BoardStateType state(m_size, std::vector<char>(m_size, '.'));
+	return std::visit([&](auto& core)
+	{
+		auto undo = core.ApplyShot(cell.GetIndex());
+		return UndoType{ undo.cell, undo.result };
+	}, m_core);
+}
 
-	// Всегда показываем промахи
-	for (const auto& miss : m_misses)
+void GameBoard::UndoShot(const UndoType& undo)
+{
+	// Записи плотного поля - 16-битные: клетка сужается до типа ядра
+	std::visit([&](auto& core)
 	{
-		state[miss.first][miss.second] = 'O';
-	}
+		using CoreUndoType = typename std::decay_t<decltype(core)>::UndoType;
+		core.UndoShot(CoreUndoType{ decltype(CoreUndoType::cell)(undo.cell), undo.result });
+	}, m_core);
+}
+
+bool GameBoard::IsAllShipsSunk() const
+{
+	return std::visit([](const auto& core) { return core.IsAllShipsSunk(); }, m_core);
+}
+
+int GameBoard::GetShipCount() const
+{
+	return std::visit([](const auto& core) { return core.GetShipCount(); }, m_core);
+}
 
-	// Всегда показываем попадания
-	for (const auto& ship : m_ships)
+int GameBoard::GetAliveShipCount() const
+{
+	return std::visit([](const auto& core) { return core.GetAliveShipCount(); }, m_core);
+}
+
+Ship GameBoard::GetShip(int shipId) const
+{
+	// Корабль собирается по записи ядра вместе с попаданиями в него
+	return std::visit([&](const auto& core)
 	{
-		for (const auto& coord : ship.GetCoordinates())
+		const auto& record = core.GetShipRecord(shipId);
+		Ship ship(record.size, WideCell(record.start), record.isHorizontal, m_size);
+		for (WideCell cell : ship.GetCoordinates())
 		{
-			if (m_shots.find(coord) != m_shots.end())
+			if (core.IsShot(cell.GetIndex()))
 			{
-				state[coord.first][coord.second] = 'X';
+				ship.TakeHit(cell);
 			}
 		}
+		return ship;
+	}, m_core);
+}
+
+GameBoard::ViewType GameBoard::GetView(bool forOwner) const
+{
+	// Виды поддерживаются ядром при расстановке и выстрелах - здесь ничего не строится.
+	// У большого поля вида целиком нет: клетки читаются через GetViewCell или GetViewport
+	assert(!IsSparseSize(m_size) && "GetView недоступен для большого поля");
+	return std::visit([&](const auto& core) { return core.GetView(forOwner); }, m_core);
+}
+
+char GameBoard::GetViewCell(bool forOwner, WideCell cell) const
+{
+	if (!cell.IsValid() || cell.GetIndex() >= m_size * m_size)
+	{
+		return BoardCore<0>::VIEW_UNKNOWN;
 	}
+	return std::visit([&](const auto& core) { return core.GetViewCell(forOwner, cell.GetIndex()); }, m_core);
+}
 
-	// Показываем корабли ТОЛЬКО если это поле владельца
-	if (forOwner)
+void GameBoard::GetViewport(bool forOwner, int top, int left, int height, int width, ViewportType& viewport) const
+{
+	// Окно обрезается краем поля; строится только то, что будет показано
+	top = std::max(top, 0);
+	left = std::max(left, 0);
+	height = std::max(std::min(height, m_size - top), 0);
+	width = std::max(std::min(width, m_size - left), 0);
+	viewport.assign(static_cast<size_t>(height) * width, BoardCore<0>::VIEW_UNKNOWN);
+	std::visit([&](const auto& core)
 	{
-		for (const auto& ship : m_ships)
+		for (int row = 0; row < height; row++)
 		{
-			for (const auto& coord : ship.GetCoordinates())
+			for (int col = 0; col < width; col++)
 			{
-				// Показываем неподбитые части кораблей
-				if (m_shots.find(coord) == m_shots.end())
-				{
-					state[coord.first][coord.second] = 'S';
-				}
+				viewport[row * width + col] = core.GetViewCell(forOwner, (top + row) * m_size + left + col);
 			}
 		}
+	}, m_core);
+}
+
+// Флот для поля: стандартный, а на больших полях - стандартный, повторенный
+// столько раз, во сколько площадь поля больше площади MAX_DENSE_BOARD_SIZE x
+// MAX_DENSE_BOARD_SIZE (с округлением). Выше MAX_DENSE_BOARD_SIZE плотность флота
+// постоянна, и на границе плотного и большого поля флот не скачет
+GameBoard::ShipSizesType GameBoard::MakeFleetSizes(int boardSize)
+{
+	ShipSizesType sizes = MakeShipSizes(DEFAULT_SHIP_CONFIG);
+	if (!IsSparseSize(boardSize))
+	{
+		return sizes;
 	}
 
-	return state;
+	long long denseArea = static_cast<long long>(MAX_DENSE_BOARD_SIZE) * MAX_DENSE_BOARD_SIZE;
+	long long scale = std::max((static_cast<long long>(boardSize) * boardSize + denseArea / 2) / denseArea, 1LL);
+	ShipSizesType scaled;
+	scaled.reserve(sizes.size() * scale);
+	for (int size : sizes)
+	{
+		scaled.insert(scaled.end(), scale, size);
+	}
+	return scaled;
 }
 
 // Кастомные размеры кораблей в зависимости от размера поля
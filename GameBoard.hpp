@@ -1,47 +1,111 @@
 ﻿#pragma once
 
 #include <vector>
-#include <set>
 #include <utility>
 #include <string>
 #include <array>
+#include <variant>
+#include <span>
+#include "Cell.hpp"
 #include "Ship.hpp"
+#include "BoardCore.hpp"
+#include "SparseBoardCore.hpp"
+#include "RuleSet.hpp"
 
+// Поле игрока. Состояние хранится в BoardCore<N> для размеров 8, 10, 12 и 16
+// (без кучи, с циклами известной длины), в BoardCore<0> для остальных размеров
+// до MAX_DENSE_BOARD_SIZE и в SparseBoardCore для больших полей, где память
+// зависит от числа выстрелов, а не от площади. Методы GameBoard только
+// выбирают нужную специализацию. Большое поле целиком не рисуется: GetView
+// для него недоступен (assert), вместо него используются GetViewCell и GetViewport.
+// ApplyShot и UndoShot позволяют перебору пробовать выстрелы и отменять их
+// за O(1) без копирования поля. Поля 8, 10, 12 и 16 можно сохранить
+// в BoardSnapshot<N> и создать из него новое поле.
+// Клетки в интерфейсе - WideCell: ход может прийти на поле любого размера.
+// Плотные ядра хранят и пишут в журнал 16-битную Cell, поэтому отмена выстрела
+// (UndoType) сужается при передаче в BoardCore и расширяется обратно.
+// Правило касания задается при создании поля (по умолчанию корабли не касаются,
+// как в RussianRules): поле с другим правилом хранится в BoardCore<0, ADJACENCY>
+// любого плотного размера. Большое поле и снимки - только без касаний.
 class GameBoard
 {
 public:
 	static const int DEFAULT_BOARD_SIZE = 10;
-	static constexpr std::array<std::pair<int, int>, 4> DEFAULT_SHIP_CONFIG = {
-		{{ 4, 1 }, { 3, 2 }, { 2, 3 }, { 1, 4 }}
-	};
+	static const int NO_SHIP = -1;
+	static const int MAX_BOARD_SIZE = WideCell::MAX_BOARD_SIZE;
+	static const int MAX_DENSE_BOARD_SIZE = 64;   // Больше - SparseBoardCore и флот, растущий с площадью (MakeFleetSizes)
+	static constexpr std::array<std::pair<int, int>, 4> DEFAULT_SHIP_CONFIG = RussianRules::SHIP_CONFIG;
 
 	// публичные: переопределение типом
-	using ShipsType = std::vector<Ship>;
-	using ShotsType = std::set<std::pair<int, int>>;
-	using MissesType = std::vector<std::pair<int, int>>;
-	using BoardStateType = std::vector<std::vector<char>>;
+	using ViewType = std::span<const char>;   // [row * size + col]
 	using ShipSizesType = std::vector<int>;
+	using UndoType = WideShotUndo;
+	using Adjacency = PlacementTables::Adjacency;
+	using CoreType = std::variant<BoardCore<8>, BoardCore<10>, BoardCore<12>, BoardCore<16>, BoardCore<0>, SparseBoardCore,
+		BoardCore<0, Adjacency::eTouch>, BoardCore<0, Adjacency::eDiagonal>>;
+	using ViewportType = std::vector<char>;   // [row * width + col] от угла окна
 
 public:
 	// конструкторы и деконструктор
-	GameBoard(int size);
+	GameBoard(int size, Adjacency adjacency = RussianRules::ADJACENCY);
+	template <int N>
+	explicit GameBoard(const BoardSnapshot<N>& snapshot)
+		: m_size(N)
+		, m_adjacency(RussianRules::ADJACENCY)
+		, m_core(std::in_place_type<BoardCore<N>>, snapshot)
+	{
+	}
 	~GameBoard() = default;
 
 	// публичные методы
+	bool CanPlaceShip(int size, WideCell start, bool isHorizontal) const;
+	bool PlaceShip(int size, WideCell start, bool isHorizontal);
 	bool PlaceShip(const Ship& ship);
-	Ship::ShotResult ReceiveShot(std::pair<int, int> coord);
+	Ship::ShotResult ReceiveShot(WideCell cell);
+	void ReceiveShots(std::span<const Cell> cells, std::span<Ship::ShotResult> results);
+	void ReceiveShots(std::span<const WideCell> cells, std::span<Ship::ShotResult> results);
+	UndoType ApplyShot(WideCell cell);
+	void UndoShot(const UndoType& undo);
+	bool operator==(const GameBoard& other) const = default;
+
+	// false, если размер поля не N
+	template <int N>
+	bool TakeSnapshot(BoardSnapshot<N>& snapshot) const
+	{
+		const BoardCore<N>* core = std::get_if<BoardCore<N>>(&m_core);
+		if (!core)
+		{
+			return false;
+		}
+		core->TakeSnapshot(snapshot);
+		return true;
+	}
 	bool IsAllShipsSunk() const;
-	BoardStateType GetVisibleState(bool forOwner) const;
+	ViewType GetView(bool forOwner) const;
+	char GetViewCell(bool forOwner, WideCell cell) const;
+	void GetViewport(bool forOwner, int top, int left, int height, int width, ViewportType& viewport) const;
+	Ship GetShip(int shipId) const;
 	static ShipSizesType MakeShipSizes(std::array < std::pair<int, int>, 4> shipConfig);
+	static ShipSizesType MakeFleetSizes(int boardSize);
+	static bool IsSparseSize(int boardSize) { return boardSize > MAX_DENSE_BOARD_SIZE; }
+	static RuleChoice MakeRules(int boardSize) { return { boardSize, MakeFleetSizes(boardSize), RussianRules::ADJACENCY }; }
 
 	// геттеры
 	int GetSize() const { return m_size; }
-	const ShipsType& GetShips() const { return m_ships; }
+	Adjacency GetAdjacency() const { return m_adjacency; }
+	int GetShipCount() const;
+	int GetAliveShipCount() const;
+	const CoreType& GetCore() const { return m_core; }
+
+private:
+	// приватные методы
+	static CoreType MakeCore(int size, Adjacency adjacency);
+	template <class CellType>
+	void ReceiveSalvo(std::span<const CellType> cells, std::span<Ship::ShotResult> results);
 
 private:
 	// приватные переменные
 	int m_size;
-	ShipsType m_ships;
-	ShotsType m_shots;
-	MissesType m_misses;
+	Adjacency m_adjacency;
+	CoreType m_core;
 };
@@ -1,9 +1,11 @@
 ﻿#include "GameManager.hpp"
 #include "UserInterface.hpp"
 #include <iostream>
+#include <vector>
 
-GameManager::GameManager(int boardSize)
-	: m_gameOver(false)
+GameManager::GameManager(int boardSize, GameMode mode, LayoutPool* layoutPool)
+	: m_mode(mode)
+	, m_gameOver(false)
 	, m_userInterface(new UserInterface(this))
 {
 	m_player1 = new HumanPlayer("Игрок 1", boardSize);
@@ -11,6 +13,10 @@ GameManager::GameManager(int boardSize)
 
 	m_currentPlayer = m_player1;
 
+	// Общий пул расстановок сервера, если он есть
+	m_player1->SetLayoutPool(layoutPool);
+	m_player2->SetLayoutPool(layoutPool);
+
 	// Устанавливаем ссылки на поля противников
 	m_player1->SetEnemyBoard(&m_player2->GetMyBoard());
 	m_player2->SetEnemyBoard(&m_player1->GetMyBoard());
@@ -36,6 +42,12 @@ void GameManager::SetupGame()
 
 void GameManager::RunGameLoop()
 {
+	if (m_mode == GameMode::eSalvo)
+	{
+		RunSalvoLoop();
+		return;
+	}
+
 	while (!m_gameOver)
 	{
 		AIPlayer* aiPlayer = dynamic_cast<AIPlayer*>(m_currentPlayer);
@@ -60,24 +72,7 @@ void GameManager::RunGameLoop()
 		}
 
 		// Отображение результата
-		std::cout << m_currentPlayer->GetName() << " стреляет в ("
-			<< move.first << ", " << move.second << ") - ";
-
-		switch (result)
-		{
-		case Ship::ShotResult::eHit:
-			std::cout << "ПОПАДАНИЕ!\n";
-			break;
-		case Ship::ShotResult::eSunk:
-			std::cout << "КОРАБЛЬ ПОТОПЛЕН!\n";
-			break;
-		case Ship::ShotResult::eMiss:
-			std::cout << "ПРОМАХ!\n";
-			break;
-		case Ship::ShotResult::eAlreadyShot:
-			std::cout << "Уже стреляли сюда!\n";
-			break;
-		}
+		DisplayShotResult(move, enemyBoard->GetSize(), result);
 
 		// Показываем состояние после хода
 		if (!aiPlayer)
@@ -87,10 +82,7 @@ void GameManager::RunGameLoop()
 		// Проверка окончания игры
 		if (enemyBoard->IsAllShipsSunk())
 		{
-			m_gameOver = true;
-			std::cout << "\n=== ИГРА ОКОНЧЕНА ===\n";
-			std::cout << m_currentPlayer->GetName() << " ПОБЕДИЛ!\n";
-			m_userInterface->ShowGameOver(m_currentPlayer->GetName());
+			FinishGame();
 			break;
 		}
 
@@ -110,6 +102,86 @@ void GameManager::RunGameLoop()
 	}
 }
 
+void GameManager::RunSalvoLoop()
+{
+	Player::SalvoType salvo;
+	std::vector<Ship::ShotResult> results;
+
+	while (!m_gameOver)
+	{
+		AIPlayer* aiPlayer = dynamic_cast<AIPlayer*>(m_currentPlayer);
+		if (!aiPlayer)
+		{
+			DisplayGameState();
+		}
+
+		// Залп по числу своих непотопленных кораблей, все выстрелы разрешаются одним вызовом
+		m_currentPlayer->MakeSalvo(m_currentPlayer->GetMyBoard().GetAliveShipCount(), salvo);
+		GameBoard* enemyBoard = m_currentPlayer->GetEnemyBoard();
+		results.resize(salvo.size());
+		enemyBoard->ReceiveShots(salvo, results);
+
+		for (size_t shot = 0; shot < salvo.size(); shot++)
+		{
+			if (aiPlayer)
+			{
+				aiPlayer->UpdateAIState(results[shot], salvo[shot]);
+			}
+			DisplayShotResult(salvo[shot], enemyBoard->GetSize(), results[shot]);
+		}
+
+		if (!aiPlayer)
+		{
+			DisplayGameState();
+		}
+		if (enemyBoard->IsAllShipsSunk())
+		{
+			FinishGame();
+			break;
+		}
+
+		// В залповом режиме ход переходит всегда
+		SwitchTurn();
+
+		if (!aiPlayer)
+		{
+			std::cout << "Нажмите Enter для продолжения...";
+			std::cin.ignore();
+			std::cin.get();
+		}
+	}
+}
+
+void GameManager::DisplayShotResult(Player::MoveType move, int boardSize, Ship::ShotResult result)
+{
+	std::cout << m_currentPlayer->GetName() << " стреляет в ("
+		<< move.GetRow(boardSize) << ", " << move.GetCol(boardSize) << ") - ";
+
+	switch (result)
+	{
+	case Ship::ShotResult::eHit:
+		std::cout << "ПОПАДАНИЕ!\n";
+		break;
+	case Ship::ShotResult::eSunk:
+		std::cout << "КОРАБЛЬ ПОТОПЛЕН!\n";
+		break;
+	case Ship::ShotResult::eMiss:
+		std::cout << "ПРОМАХ!\n";
+		break;
+	case Ship::ShotResult::eAlreadyShot:
+		std::cout << "Уже стреляли сюда!\n";
+		break;
+	}
+}
+
+void GameManager::FinishGame()
+{
+	m_gameOver = true;
+	std::cout << "\n=== ИГРА ОКОНЧЕНА ===\n";
+	std::cout << m_currentPlayer->GetName() << " ПОБЕДИЛ!\n";
+	m_userInterface->ShowGameOver(m_currentPlayer->GetName());
+}
+
 void GameManager::SwitchTurn()
 {
 	if (m_currentPlayer == m_player1)
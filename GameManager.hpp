@@ -9,9 +9,17 @@ class UserInterface;
 
 class GameManager
 {
+public:
+	// Правила очередности выстрелов
+	enum class GameMode
+	{
+		eClassic = 0,  // Один выстрел, при попадании ход сохраняется
+		eSalvo = 1     // Залп: столько выстрелов, сколько у стреляющего непотопленных кораблей
+	};
+
 public:
 	// конструкторы и деконструктор
-	GameManager(int boardSize);
+	GameManager(int boardSize, GameMode mode = GameMode::eClassic, LayoutPool* layoutPool = nullptr);
 	~GameManager();
 
 	// публичные методы
@@ -24,12 +32,20 @@ public:
 	Player* GetCurrentPlayer() const { return m_currentPlayer; }
 	Player* GetPlayer1() const { return m_player1; }
 	Player* GetPlayer2() const { return m_player2; }
+	GameMode GetMode() const { return m_mode; }
+
+private:
+	// приватные методы
+	void RunSalvoLoop();
+	void DisplayShotResult(Player::MoveType move, int boardSize, Ship::ShotResult result);
+	void FinishGame();
 
 private:
 	// приватные переменные
 	Player* m_player1;
 	Player* m_player2;
 	Player* m_currentPlayer;
+	GameMode m_mode;
 	bool m_gameOver;
 	UserInterface* m_userInterface;
 };
@@ -1,11 +1,14 @@
 ﻿#include "HumanPlayer.hpp"
+#include "FleetGenerator.hpp"
+#include "LayoutPool.hpp"
+#include "UserInterface.hpp"
 #include <random>
 #include <algorithm>
 
 HumanPlayer::HumanPlayer(std::string name, int boardSize)
 	: Player(name, boardSize)
 {
-	shipSizes = GameBoard::MakeShipSizes(GameBoard::DEFAULT_SHIP_CONFIG);
+	shipSizes = GameBoard::MakeFleetSizes(boardSize);
 }
 
 void HumanPlayer::PlaceShips()
@@ -80,27 +83,22 @@ void HumanPlayer::AutomaticPlacement()
 	std::random_device rd;
 	std::mt19937 gen(rd());
 
-	for (int size : shipSizes)
+	// Готовая расстановка из пула, если он подключен
+	bool placed = false;
+	if (m_layoutPool)
 	{
-		bool placed = false;
-		int attempts = 0;
-
-		while (!placed && attempts < MAX_ATTEMPTS) // Ограничение на попытки
-		{
-			int row = gen() % m_myBoard.GetSize();
-			int col = gen() % m_myBoard.GetSize();
-			bool horizontal = gen() % 2 == 0;
-
-			placed = TryPlaceShip(size, row, col, horizontal);
-			attempts++;
-		}
-
-		if (!placed)
-		{
-			std::cout << "Не удалось автоматически разместить корабль размером " << size << ". Попробуйте ручную расстановку.\n";
-			ManualPlacement();
-			return;
-		}
+		placed = m_layoutPool->PlaceFleet(m_myBoard, m_layoutFleet, shipSizes, gen);
+	}
+	else
+	{
+		FleetGenerator generator(m_myBoard.GetSize(), shipSizes);
+		placed = generator.PlaceFleet(m_myBoard, gen);
+	}
+	if (!placed)
+	{
+		std::cout << "Не удалось автоматически расставить флот. Попробуйте ручную расстановку.\n";
+		ManualPlacement();
+		return;
 	}
 
 	std::cout << "Все корабли успешно расставлены автоматически!\n";
@@ -109,7 +107,7 @@ void HumanPlayer::AutomaticPlacement()
 
 bool HumanPlayer::TryPlaceShip(int size, int row, int col, bool horizontal)
 {
-	Ship ship(size, { row, col }, horizontal);
+	Ship ship(size, MoveType::FromRowCol(row, col, m_myBoard.GetSize()), horizontal, m_myBoard.GetSize());
 	return m_myBoard.PlaceShip(ship);
 }
 
@@ -122,29 +120,55 @@ Player::MoveType HumanPlayer::MakeMove()
 	int col = GetValidatedInput("Введите номер столбца (0-" + std::to_string(m_myBoard.GetSize() - 1) + "): ",
 		0, m_myBoard.GetSize() - 1);
 
-	return { row, col };
+	// Ряд и столбец пользователя дальше передаются только индексом клетки
+	return MoveType::FromRowCol(row, col, m_myBoard.GetSize());
+}
+
+void HumanPlayer::MakeSalvo(int shotCount, SalvoType& salvo)
+{
+	std::cout << m_name << ", ваш залп из " << shotCount << " выстрелов:\n";
+
+	salvo.clear();
+	while (static_cast<int>(salvo.size()) < shotCount)
+	{
+		std::cout << "Выстрел " << salvo.size() + 1 << " из " << shotCount << "\n";
+		int row = GetValidatedInput("Введите номер ряда (0-" + std::to_string(m_myBoard.GetSize() - 1) + "): ",
+			0, m_myBoard.GetSize() - 1);
+		int col = GetValidatedInput("Введите номер столбца (0-" + std::to_string(m_myBoard.GetSize() - 1) + "): ",
+			0, m_myBoard.GetSize() - 1);
+
+		MoveType move = MoveType::FromRowCol(row, col, m_myBoard.GetSize());
+		if (std::find(salvo.begin(), salvo.end(), move) != salvo.end())
+		{
+			std::cout << "Эта клетка уже есть в залпе. Выберите другую.\n";
+			continue;
+		}
+		salvo.push_back(move);
+	}
 }
 
 void HumanPlayer::DisplayBoardState()
 {
-	// При расстановке показываем корабли (forOwner = true)
-	auto state = m_myBoard.GetVisibleState(true);
+	// При расстановке показываем корабли (forOwner = true); большое поле - только угол
+	int size = std::min(m_myBoard.GetSize(), UserInterface::MAX_VIEWPORT_SIZE);
+	GameBoard::ViewportType state;
+	m_myBoard.GetViewport(true, 0, 0, size, size, state);
 	std::cout << "Ваше поле:\n";
 
 	// Вывод номеров столбцов
 	std::cout << "  ";
-	for (int j = 0; j < m_myBoard.GetSize(); j++)
+	for (int j = 0; j < size; j++)
 	{
 		std::cout << j << " ";
 	}
 	std::cout << "\n";
 
-	for (int i = 0; i < m_myBoard.GetSize(); i++)
+	for (int i = 0; i < size; i++)
 	{
 		std::cout << i << " ";
-		for (int j = 0; j < m_myBoard.GetSize(); j++)
+		for (int j = 0; j < size; j++)
 		{
-			std::cout << state[i][j] << " ";
+			std::cout << state[i * size + j] << " ";
 		}
 		std::cout << "\n";
 	}
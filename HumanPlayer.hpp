@@ -14,8 +14,8 @@ public:
 	// публичные методы
 	void PlaceShips() override;
 	MoveType MakeMove() override;
+	void MakeSalvo(int shotCount, SalvoType& salvo) override;
 
-	static const int MAX_ATTEMPTS = 100;
 	GameBoard::ShipSizesType shipSizes;
 
 private:
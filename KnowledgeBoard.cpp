@@ -0,0 +1,197 @@
+﻿#include "KnowledgeBoard.hpp"
+#include <algorithm>
+
+KnowledgeBoard::KnowledgeBoard(int boardSize, const ShipCountsType& shipCounts)
+	: m_boardSize(boardSize)
+	, m_empty(boardSize * boardSize)
+	, m_ship(boardSize * boardSize)
+	, m_remainingShips(shipCounts)
+	, m_minLength(0)
+	, m_sweepAll(false)
+{
+	UpdateMinLength();
+}
+
+void KnowledgeBoard::MarkMiss(int cell, CellsType& inferred)
+{
+	inferred.clear();
+	// Сам промах вызывающий уже отметил - в выводы он не попадает
+	MarkEmpty(cell / m_boardSize, cell % m_boardSize, inferred);
+	inferred.clear();
+	SweepDeadCells(inferred);
+}
+
+void KnowledgeBoard::MarkHit(int cell, CellsType& inferred)
+{
+	inferred.clear();
+	if (m_ship.Test(cell))
+	{
+		return;
+	}
+	m_ship.Set(cell);
+	m_empty.Reset(cell);
+
+	// Диагональные соседи: у соседнего попадания это бока корабля
+	int row = cell / m_boardSize;
+	int col = cell % m_boardSize;
+	for (int rowStep : { -1, 1 })
+	{
+		for (int colStep : { -1, 1 })
+		{
+			MarkEmpty(row + rowStep, col + colStep, inferred);
+		}
+	}
+	SweepDeadCells(inferred);
+}
+
+void KnowledgeBoard::MarkSunk(const CellsType& shipCells, CellsType& inferred)
+{
+	inferred.clear();
+	for (int cell : shipCells)
+	{
+		m_ship.Set(cell);
+		m_empty.Reset(cell);
+	}
+
+	// Вокруг потопленного корабля других кораблей быть не может
+	for (int cell : shipCells)
+	{
+		for (int row = cell / m_boardSize - 1; row <= cell / m_boardSize + 1; row++)
+		{
+			for (int col = cell % m_boardSize - 1; col <= cell % m_boardSize + 1; col++)
+			{
+				MarkEmpty(row, col, inferred);
+			}
+		}
+	}
+
+	int length = static_cast<int>(shipCells.size());
+	if (length < static_cast<int>(m_remainingShips.size()) && m_remainingShips[length] > 0)
+	{
+		m_remainingShips[length]--;
+		UpdateMinLength();
+	}
+	SweepDeadCells(inferred);
+}
+
+KnowledgeBoard::Axis KnowledgeBoard::GetAxis(int cell) const
+{
+	int row = cell / m_boardSize;
+	int col = cell % m_boardSize;
+	if ((col > 0 && m_ship.Test(cell - 1)) || (col + 1 < m_boardSize && m_ship.Test(cell + 1)))
+	{
+		return Axis::eHorizontal;
+	}
+	if ((row > 0 && m_ship.Test(cell - m_boardSize)) || (row + 1 < m_boardSize && m_ship.Test(cell + m_boardSize)))
+	{
+		return Axis::eVertical;
+	}
+	return Axis::eUnknown;
+}
+
+bool KnowledgeBoard::IsOpen(int row, int col) const
+{
+	return row >= 0 && row < m_boardSize && col >= 0 && col < m_boardSize && !m_empty.Test(row * m_boardSize + col);
+}
+
+int KnowledgeBoard::CountOpen(int row, int col, int rowStep, int colStep, int limit) const
+{
+	int count = 0;
+	while (count < limit && IsOpen(row + rowStep * (count + 1), col + colStep * (count + 1)))
+	{
+		count++;
+	}
+	return count;
+}
+
+bool KnowledgeBoard::IsDead(int row, int col) const
+{
+	// Клетки кораблей считаются открытыми: рядом с потопленным и так пусто,
+	// а незавершенное попадание может продолжиться в эту клетку.
+	// Отрезок нужен не длиннее m_minLength, поэтому счет на этом обрывается
+	int need = m_minLength - 1;
+	if (CountOpen(row, col, 0, -1, need) + CountOpen(row, col, 0, 1, need) >= need)
+	{
+		return false;
+	}
+	return CountOpen(row, col, -1, 0, need) + CountOpen(row, col, 1, 0, need) < need;
+}
+
+void KnowledgeBoard::MarkEmpty(int row, int col, CellsType& inferred)
+{
+	if (row < 0 || row >= m_boardSize || col < 0 || col >= m_boardSize)
+	{
+		return;
+	}
+	int cell = row * m_boardSize + col;
+	if (m_empty.Test(cell) || m_ship.Test(cell))
+	{
+		return;
+	}
+	m_empty.Set(cell);
+	m_changedCells.push_back(cell);
+	inferred.push_back(cell);
+}
+
+void KnowledgeBoard::SweepDeadCells(CellsType& inferred)
+{
+	// Новая пустая клетка укорачивает отрезки только своего ряда и столбца и
+	// только ближе m_minLength к ней, поэтому проверяются лишь эти клетки.
+	// Мертвая клетка лежит на коротких отрезках в обе стороны, и ее закрытие
+	// не делает мертвыми другие. Пока живы однопалубные, мертвых клеток нет
+	m_deadCells.clear();
+	if (m_sweepAll)
+	{
+		for (int cell = 0; cell < m_boardSize * m_boardSize; cell++)
+		{
+			if (IsUnknown(cell) && IsDead(cell / m_boardSize, cell % m_boardSize))
+			{
+				m_deadCells.push_back(cell);
+			}
+		}
+	}
+	else if (m_minLength > 1)
+	{
+		const int directions[4][2] = { {0, 1}, {1, 0}, {0, -1}, {-1, 0} };
+		for (int cell : m_changedCells)
+		{
+			for (auto& dir : directions)
+			{
+				int row = cell / m_boardSize + dir[0];
+				int col = cell % m_boardSize + dir[1];
+				for (int step = 1; step < m_minLength && IsOpen(row, col); step++)
+				{
+					if (IsUnknown(row * m_boardSize + col) && IsDead(row, col))
+					{
+						m_deadCells.push_back(row * m_boardSize + col);
+					}
+					row += dir[0];
+					col += dir[1];
+				}
+			}
+		}
+	}
+
+	for (int cell : m_deadCells)
+	{
+		MarkEmpty(cell / m_boardSize, cell % m_boardSize, inferred);
+	}
+	m_changedCells.clear();
+	m_sweepAll = false;
+}
+
+void KnowledgeBoard::UpdateMinLength()
+{
+	// Флот потоплен целиком - кораблю негде поместиться, мертво все
+	int minLength = m_boardSize + 1;
+	for (int length = 1; length < static_cast<int>(m_remainingShips.size()); length++)
+	{
+		if (m_remainingShips[length] > 0)
+		{
+			minLength = length;
+			break;
+		}
+	}
+	m_sweepAll = m_sweepAll || minLength != m_minLength;
+	m_minLength = minLength;
+}
@@ -0,0 +1,82 @@
+﻿#pragma once
+
+#include <vector>
+#include <cstdint>
+#include "BitBoard.hpp"
+
+// Что ИИ знает о поле противника по правилу "корабли не касаются": клетка
+// неизвестна, пуста (корабля в ней нет или быть не может) или занята
+// кораблем. Знание хранится двумя масками - m_empty и m_ship, - поэтому
+// любой запрос - проверка бита. После каждого выстрела выводятся следствия:
+//  - вокруг потопленного корабля пусто;
+//  - по диагонали от попадания пусто: корабль прямой, а другой бы касался.
+//    Поэтому второе попадание рядом задает направление корабля - клетки
+//    по бокам закрываются, открытыми остаются только концы;
+//  - клетка, через которую по горизонтали и вертикали не проходит отрезок
+//    не пустых клеток длиной с самый короткий оставшийся корабль, мертва.
+// Выведенные пустые клетки возвращаются вызывающему, чтобы он обновил
+// свои структуры (плотность, маски рядов).
+class KnowledgeBoard
+{
+public:
+	// Знание о клетке
+	enum class Knowledge : std::uint8_t
+	{
+		eUnknown = 0,
+		eEmpty = 1,
+		eShip = 2
+	};
+
+	// Направление корабля, выведенное по соседним попаданиям
+	enum class Axis : std::uint8_t
+	{
+		eUnknown = 0,
+		eHorizontal = 1,
+		eVertical = 2
+	};
+
+	// публичные: переопределение типом
+	using CellsType = std::vector<int>;
+	using ShipCountsType = std::vector<int>;
+
+public:
+	// конструкторы и деконструктор
+	KnowledgeBoard(int boardSize, const ShipCountsType& shipCounts);
+	~KnowledgeBoard() = default;
+
+	// публичные методы
+	void MarkMiss(int cell, CellsType& inferred);
+	void MarkHit(int cell, CellsType& inferred);
+	void MarkSunk(const CellsType& shipCells, CellsType& inferred);
+	Axis GetAxis(int cell) const;
+
+	// геттеры
+	Knowledge GetKnowledge(int cell) const
+	{
+		return m_ship.Test(cell) ? Knowledge::eShip : m_empty.Test(cell) ? Knowledge::eEmpty : Knowledge::eUnknown;
+	}
+	bool IsUnknown(int cell) const { return !m_empty.Test(cell) && !m_ship.Test(cell); }
+	bool IsEmpty(int cell) const { return m_empty.Test(cell); }
+	bool IsShip(int cell) const { return m_ship.Test(cell); }
+	int GetMinLength() const { return m_minLength; }
+
+private:
+	// приватные методы
+	bool IsOpen(int row, int col) const;
+	int CountOpen(int row, int col, int rowStep, int colStep, int limit) const;
+	bool IsDead(int row, int col) const;
+	void MarkEmpty(int row, int col, CellsType& inferred);
+	void SweepDeadCells(CellsType& inferred);
+	void UpdateMinLength();
+
+private:
+	// приватные переменные
+	int m_boardSize;
+	BitBoard m_empty;
+	BitBoard m_ship;
+	ShipCountsType m_remainingShips;       // Число непотопленных кораблей по длине
+	int m_minLength;                       // Самый короткий непотопленный корабль
+	CellsType m_changedCells;              // Клетки, ставшие пустыми после прошлой проверки
+	CellsType m_deadCells;
+	bool m_sweepAll;                       // Короткий корабль кончился - проверяется все поле
+};
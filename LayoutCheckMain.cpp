@@ -0,0 +1,205 @@
+﻿#include <iostream>
+#include <fstream>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <random>
+#include <algorithm>
+#include "LayoutValidator.hpp"
+#include "RuleSet.hpp"
+
+// battleship_layoutcheck - пакетная проверка расстановок из файла
+// Использование:
+//   battleship_layoutcheck FILE [--rules russian|hasbro|diagonal] [--threads T] [--report FILE]
+//       проверить все расстановки файла; недопустимые выводятся строками
+//       "номер<TAB>код<TAB>причина" (в FILE отчета или на экран)
+//   battleship_layoutcheck --generate FILE [--count N] [--invalid P] [--seed S] [--rules ...]
+//       записать N расстановок флота правил, доля P из них испорчена
+//       (проверочные данные и замер скорости)
+namespace
+{
+	// Уникальных расстановок строится немного (каждая стоит долей миллисекунды),
+	// остальные повторяют их; испорченной расстановке переставляется один корабль
+	int Generate(const std::string& path, const RuleChoice& rules, long long count, double invalidShare, unsigned long long seed)
+	{
+		const long long uniqueLayouts = 4096;
+		std::mt19937 random(static_cast<std::uint32_t>(seed));
+		FleetGenerator generator(rules.boardSize, rules.shipSizes, rules.adjacency);
+		FleetGenerator::LayoutType layout;
+		LayoutValidator::RecordsType unique;
+		long long failed = 0;
+		for (long long i = 0; i < std::min(count, uniqueLayouts); i++)
+		{
+			// Неудавшаяся расстановка не записывается: в layout осталась бы прошлая
+			if (!generator.Generate(random, layout))
+			{
+				failed++;
+				continue;
+			}
+			LayoutValidator::EncodeLayout(layout, unique);
+		}
+
+		size_t recordSize = rules.shipSizes.size() * LayoutValidator::BYTES_PER_SHIP;
+		size_t uniqueCount = unique.size() / recordSize;
+		if (uniqueCount == 0)
+		{
+			std::cerr << "Генератор не построил ни одной расстановки для поля " << rules.boardSize << "x" << rules.boardSize << "\n";
+			return 1;
+		}
+		if (failed > 0)
+		{
+			std::cerr << "Не удалось построить расстановок: " << failed << ", повторяются удавшиеся\n";
+		}
+		LayoutValidator::RecordsType records(static_cast<size_t>(count) * recordSize);
+		std::bernoulli_distribution corrupt(invalidShare);
+		for (long long i = 0; i < count; i++)
+		{
+			std::uint8_t* record = records.data() + i * recordSize;
+			std::copy_n(unique.data() + (i % uniqueCount) * recordSize, recordSize, record);
+			if (corrupt(random))
+			{
+				size_t ship = random() % rules.shipSizes.size();
+				record[ship * LayoutValidator::BYTES_PER_SHIP] = static_cast<std::uint8_t>(random() % (rules.boardSize * rules.boardSize));
+			}
+		}
+
+		if (!LayoutValidator::WriteFile(path, rules.boardSize, static_cast<int>(rules.shipSizes.size()), records))
+		{
+			std::cerr << "Не удалось записать файл " << path << "\n";
+			return 1;
+		}
+		std::cout << "Записано расстановок: " << count << " (" << records.size() << " байт) в " << path << "\n";
+		return 0;
+	}
+
+	int Check(const std::string& path, const RuleChoice& rules, int threads, const std::string& reportPath)
+	{
+		int boardSize = 0;
+		int shipCount = 0;
+		LayoutValidator::RecordsType records;
+		if (!LayoutValidator::ReadFile(path, boardSize, shipCount, records))
+		{
+			std::cerr << "Не удалось прочитать файл расстановок " << path << "\n";
+			return 1;
+		}
+		if (boardSize != rules.boardSize || shipCount != static_cast<int>(rules.shipSizes.size()))
+		{
+			std::cerr << "Файл записан для поля " << boardSize << "x" << boardSize << " и " << shipCount
+				<< " кораблей, а правила требуют " << rules.boardSize << "x" << rules.boardSize << " и "
+				<< rules.shipSizes.size() << "\n";
+			return 1;
+		}
+
+		LayoutValidator validator(rules.boardSize, rules.shipSizes, rules.adjacency);
+		size_t layoutCount = records.size() / validator.GetRecordSize();
+		LayoutValidator::ReasonsType reasons(layoutCount);
+
+		auto start = std::chrono::steady_clock::now();
+		validator.ValidateBatch(records, reasons, threads);
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		// Отчет о недопустимых расстановках
+		std::ofstream reportFile;
+		if (!reportPath.empty())
+		{
+			reportFile.open(reportPath);
+		}
+		std::ostream& report = reportPath.empty() ? std::cout : reportFile;
+		long long counts[LayoutValidator::REASON_COUNT] = {};
+		for (size_t i = 0; i < layoutCount; i++)
+		{
+			counts[static_cast<int>(reasons[i])]++;
+			if (reasons[i] != LayoutValidator::Reason::eValid)
+			{
+				report << i << "\t" << static_cast<int>(reasons[i]) << "\t" << LayoutValidator::GetReasonName(reasons[i]) << "\n";
+			}
+		}
+
+		std::cout << "Расстановок: " << layoutCount << ", потоков " << threads << ", время " << seconds << " с\n";
+		std::cout << "Расстановок в секунду: " << (seconds > 0 ? layoutCount / seconds : 0.0) << "\n";
+		for (int reason = 0; reason < LayoutValidator::REASON_COUNT; reason++)
+		{
+			std::cout << "  " << LayoutValidator::GetReasonName(static_cast<LayoutValidator::Reason>(reason))
+				<< ": " << counts[reason] << "\n";
+		}
+		return counts[static_cast<int>(LayoutValidator::Reason::eValid)] == static_cast<long long>(layoutCount) ? 0 : 2;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	std::string path;
+	std::string generatePath;
+	std::string reportPath;
+	RuleChoice rules = RuleChoice::Make<RussianRules>();
+	int threads = std::max(1u, std::thread::hardware_concurrency());
+	long long count = 1000000;
+	double invalidShare = 0.01;
+	unsigned long long seed = 1;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg == "--rules" && i + 1 < argc)
+		{
+			if (!RuleChoice::Parse(argv[++i], rules))
+			{
+				std::cerr << "Неизвестные правила: " << argv[i] << "\n";
+				return 1;
+			}
+		}
+		else if (arg == "--threads" && i + 1 < argc)
+		{
+			threads = std::max(1, std::atoi(argv[++i]));
+		}
+		else if (arg == "--report" && i + 1 < argc)
+		{
+			reportPath = argv[++i];
+		}
+		else if (arg == "--generate" && i + 1 < argc)
+		{
+			generatePath = argv[++i];
+		}
+		else if (arg == "--count" && i + 1 < argc)
+		{
+			count = std::atoll(argv[++i]);
+		}
+		else if (arg == "--invalid" && i + 1 < argc)
+		{
+			invalidShare = std::atof(argv[++i]);
+		}
+		else if (arg == "--seed" && i + 1 < argc)
+		{
+			seed = std::strtoull(argv[++i], nullptr, 10);
+		}
+		else if (path.empty() && !arg.empty() && arg[0] != '-')
+		{
+			path = arg;
+		}
+		else
+		{
+			std::cerr << "Неизвестный параметр: " << arg << "\n";
+			path.clear();
+			generatePath.clear();
+			break;
+		}
+	}
+
+	if (!generatePath.empty())
+	{
+		if (count <= 0 || invalidShare < 0 || invalidShare > 1)
+		{
+			std::cerr << "Число расстановок должно быть положительным, доля испорченных - от 0 до 1\n";
+			return 1;
+		}
+		return Generate(generatePath, rules, count, invalidShare, seed);
+	}
+	if (path.empty())
+	{
+		std::cerr << "Использование: battleship_layoutcheck FILE [--rules russian|hasbro|diagonal] [--threads T] [--report FILE]\n"
+			<< "       battleship_layoutcheck --generate FILE [--count N] [--invalid P] [--seed S] [--rules ...]\n";
+		return 1;
+	}
+	return Check(path, rules, threads, reportPath);
+}
@@ -0,0 +1,405 @@
+﻿#include "LayoutCountTable.hpp"
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <mutex>
+#include <memory>
+#include <utility>
+#include <numeric>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <bit>
+
+LayoutCountTable::LayoutCountTable(int boardSize, const ShipSizesType& shipSizes, Adjacency adjacency)
+	: m_boardSize(boardSize)
+	, m_adjacency(adjacency)
+	, m_comboCount(1)
+	, m_fullCombo(0)
+	, m_optionCount(1)
+	, m_maskWords(1)
+{
+	ShipSizesType sorted = shipSizes;
+	std::sort(sorted.begin(), sorted.end(), std::greater<int>());
+	for (int size : sorted)
+	{
+		if (m_lengths.empty() || m_lengths.back() != size)
+		{
+			m_lengths.push_back(size);
+			m_lengthCounts.push_back(0);
+		}
+		m_lengthCounts.back()++;
+	}
+}
+
+const LayoutCountTable* LayoutCountTable::Get(int boardSize, const ShipSizesType& shipSizes, Adjacency adjacency)
+{
+	static std::mutex mutex;
+	static std::map<std::tuple<int, ShipSizesType, Adjacency>, std::unique_ptr<LayoutCountTable>> cache;
+
+	// Флот - набор длин: порядок кораблей на таблицу не влияет
+	ShipSizesType sorted = shipSizes;
+	std::sort(sorted.begin(), sorted.end());
+
+	// Неудачная постройка тоже запоминается (nullptr), чтобы не повторять ее
+	std::lock_guard<std::mutex> lock(mutex);
+	auto found = cache.find({ boardSize, sorted, adjacency });
+	if (found != cache.end())
+	{
+		return found->second.get();
+	}
+
+	auto table = std::make_unique<LayoutCountTable>(boardSize, sorted, adjacency);
+	if (!table->Build())
+	{
+		table.reset();
+	}
+	return cache.emplace(std::make_tuple(boardSize, sorted, adjacency), std::move(table)).first->second.get();
+}
+
+bool LayoutCountTable::Build()
+{
+	if (m_boardSize <= 0 || m_lengths.size() > 32)
+	{
+		return false;
+	}
+	for (int length : m_lengths)
+	{
+		if (length < 1 || length > m_boardSize)
+		{
+			return false;
+		}
+	}
+
+	// Дальняя клетка, которую задевает корабль с окрестностью от текущей клетки
+	if (!m_lengths.empty() && m_lengths.front() * m_boardSize + m_lengths.front() >= WINDOW_BITS)
+	{
+		return false;
+	}
+
+	m_strides.assign(m_lengths.size(), 0);
+	m_comboCount = 1;
+	for (size_t i = m_lengths.size(); i-- > 0;)
+	{
+		m_strides[i] = m_comboCount;
+		m_comboCount *= m_lengthCounts[i] + 1;
+		if (m_comboCount > MAX_COMBOS)
+		{
+			return false;
+		}
+	}
+
+	m_fullCombo = 0;
+	m_available.assign(m_comboCount, 0);
+	for (size_t i = 0; i < m_lengths.size(); i++)
+	{
+		m_fullCombo += m_lengthCounts[i] * m_strides[i];
+		for (int combo = 0; combo < m_comboCount; combo++)
+		{
+			if (combo / m_strides[i] % (m_lengthCounts[i] + 1) > 0)
+			{
+				m_available[combo] |= std::uint32_t(1) << i;
+			}
+		}
+	}
+	m_optionCount = 2 * static_cast<int>(m_lengths.size()) + 1;
+	m_maskWords = (m_comboCount + 63) / 64;
+
+	return DiscoverNodes() && MarkReachable() && CountLayouts();
+}
+
+void LayoutCountTable::Sample(std::mt19937& random, PicksType& picks) const
+{
+	picks.clear();
+	int node = 0;
+	int combo = m_fullCombo;
+	while (combo != 0)
+	{
+		// Число в [0, расстановок из узла) указывает на вариант текущей клетки
+		std::uint64_t rest = std::uniform_int_distribution<std::uint64_t>(0, GetCount(node, combo) - 1)(random);
+		int next = GetChild(node, m_optionCount - 1);
+		int nextCombo = combo;
+		for (size_t i = 0; i < m_lengths.size() && nextCombo == combo; i++)
+		{
+			if (!(m_available[combo] >> i & 1))
+			{
+				continue;
+			}
+			for (int vertical = 0; vertical < 2; vertical++)
+			{
+				int child = GetChild(node, 2 * static_cast<int>(i) + vertical);
+				if (child == NO_NODE)
+				{
+					continue;
+				}
+
+				std::uint64_t count = GetCount(child, combo - m_strides[i]);
+				if (rest < count)
+				{
+					picks.push_back(Pick{ m_lengths[i], m_nodeCells[node], vertical == 0 });
+					next = child;
+					nextCombo = combo - m_strides[i];
+					break;
+				}
+				rest -= count;
+			}
+		}
+		node = next;
+		combo = nextCombo;
+	}
+}
+
+size_t LayoutCountTable::NodeHash::operator()(const NodeKey& key) const
+{
+	std::uint64_t hash = key.window.low * 0x9E3779B97F4A7C15ull;
+	hash ^= (key.window.high + 0x632BE59BD9B4E019ull) * 0xBF58476D1CE4E5B9ull;
+	hash ^= static_cast<std::uint64_t>(key.cell) * 0x94D049BB133111EBull;
+	return static_cast<size_t>(hash ^ (hash >> 29));
+}
+
+bool LayoutCountTable::DiscoverNodes()
+{
+	// Обход в ширину от пустого поля. Занятые клетки пропускаются сразу,
+	// поэтому узел всегда стоит на свободной клетке или за концом поля
+	int cellCount = m_boardSize * m_boardSize;
+	std::vector<NodeKey> keys;
+	std::vector<int> children;
+	std::unordered_map<NodeKey, int, NodeHash> ids;
+	auto findNode = [&](int cell, Window window)
+	{
+		while (cell < cellCount && window.Test(0))
+		{
+			window.Shift();
+			cell++;
+		}
+		NodeKey key{ cell, window };
+		auto found = ids.find(key);
+		if (found != ids.end())
+		{
+			return found->second;
+		}
+		int id = static_cast<int>(keys.size());
+		ids.emplace(key, id);
+		keys.push_back(key);
+		return id;
+	};
+
+	findNode(0, Window{});
+	for (size_t id = 0; id < keys.size(); id++)
+	{
+		if (keys.size() > static_cast<size_t>(MAX_NODES))
+		{
+			return false;
+		}
+
+		NodeKey key = keys[id];
+		children.resize((id + 1) * m_optionCount, NO_NODE);
+		if (key.cell >= cellCount)
+		{
+			continue;
+		}
+		for (size_t i = 0; i < m_lengths.size(); i++)
+		{
+			for (int vertical = 0; vertical < 2; vertical++)
+			{
+				Window next = key.window;
+				if ((vertical == 0 || m_lengths[i] > 1) && TryPlace(key.cell, m_lengths[i], vertical == 0, next))
+				{
+					next.Shift();
+					children[id * m_optionCount + 2 * i + vertical] = findNode(key.cell + 1, next);
+				}
+			}
+		}
+		Window next = key.window;
+		next.Shift();
+		children[id * m_optionCount + m_optionCount - 1] = findNode(key.cell + 1, next);
+	}
+
+	// Узлы нумеруются по клеткам: переходы ведут только к большим номерам
+	std::vector<int> order(keys.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return keys[a].cell < keys[b].cell; });
+	std::vector<int> renumbered(keys.size());
+	for (size_t node = 0; node < order.size(); node++)
+	{
+		renumbered[order[node]] = static_cast<int>(node);
+	}
+
+	m_nodeCells.resize(keys.size());
+	m_children.assign(keys.size() * m_optionCount, NO_NODE);
+	for (size_t node = 0; node < order.size(); node++)
+	{
+		m_nodeCells[node] = keys[order[node]].cell;
+		for (int option = 0; option < m_optionCount; option++)
+		{
+			int child = children[static_cast<size_t>(order[node]) * m_optionCount + option];
+			m_children[node * m_optionCount + option] = child == NO_NODE ? NO_NODE : renumbered[child];
+		}
+	}
+	return true;
+}
+
+bool LayoutCountTable::MarkReachable()
+{
+	// Наборы оставшихся кораблей, с которыми проход от начала поля доходит до узла.
+	// Пустой набор не хранится: из любого узла он дает ровно одну расстановку
+	m_masks.assign(m_nodeCells.size() * m_maskWords, 0);
+	auto mark = [&](int node, int combo)
+	{
+		if (combo != 0)
+		{
+			m_masks[static_cast<size_t>(node) * m_maskWords + combo / 64] |= std::uint64_t(1) << (combo % 64);
+		}
+	};
+
+	long long entries = 0;
+	mark(0, m_fullCombo);
+	for (int node = 0; node < GetNodeCount(); node++)
+	{
+		for (int combo = 1; combo < m_comboCount; combo++)
+		{
+			if (!(m_masks[static_cast<size_t>(node) * m_maskWords + combo / 64] >> (combo % 64) & 1))
+			{
+				continue;
+			}
+			if (++entries > MAX_ENTRIES)
+			{
+				return false;
+			}
+
+			int empty = GetChild(node, m_optionCount - 1);
+			if (empty != NO_NODE)
+			{
+				mark(empty, combo);
+			}
+			for (size_t i = 0; i < m_lengths.size(); i++)
+			{
+				for (int vertical = 0; vertical < 2 && (m_available[combo] >> i & 1); vertical++)
+				{
+					int child = GetChild(node, 2 * static_cast<int>(i) + vertical);
+					if (child != NO_NODE)
+					{
+						mark(child, combo - m_strides[i]);
+					}
+				}
+			}
+		}
+	}
+	return true;
+}
+
+bool LayoutCountTable::CountLayouts()
+{
+	// От конца поля к началу: числа всех переходов узла уже посчитаны.
+	// В таблице остаются только ненулевые числа, их место - по рангу бита маски
+	m_ranks.assign(m_masks.size(), 0);
+	m_counts.clear();
+	std::vector<std::uint64_t> values(m_comboCount, 0);
+	for (int node = GetNodeCount() - 1; node >= 0; node--)
+	{
+		std::uint64_t* mask = &m_masks[static_cast<size_t>(node) * m_maskWords];
+		for (int combo = 1; combo < m_comboCount; combo++)
+		{
+			if (!(mask[combo / 64] >> (combo % 64) & 1))
+			{
+				continue;
+			}
+
+			std::uint64_t total = 0;
+			auto add = [&](int child, int childCombo)
+			{
+				std::uint64_t count = child == NO_NODE ? 0 : GetCount(child, childCombo);
+				if (total > std::numeric_limits<std::uint64_t>::max() - count)
+				{
+					return false;
+				}
+				total += count;
+				return true;
+			};
+
+			bool fits = add(GetChild(node, m_optionCount - 1), combo);
+			for (size_t i = 0; i < m_lengths.size(); i++)
+			{
+				for (int vertical = 0; vertical < 2 && (m_available[combo] >> i & 1); vertical++)
+				{
+					fits = add(GetChild(node, 2 * static_cast<int>(i) + vertical), combo - m_strides[i]) && fits;
+				}
+			}
+			if (!fits)
+			{
+				return false;
+			}
+			values[combo] = total;
+		}
+
+		for (int word = 0; word < m_maskWords; word++)
+		{
+			m_ranks[static_cast<size_t>(node) * m_maskWords + word] = static_cast<std::uint32_t>(m_counts.size());
+			for (std::uint64_t bits = mask[word]; bits != 0; bits &= bits - 1)
+			{
+				int combo = word * 64 + std::countr_zero(bits);
+				if (values[combo] == 0)
+				{
+					mask[word] &= ~(std::uint64_t(1) << (combo % 64));
+				}
+				else
+				{
+					m_counts.push_back(values[combo]);
+				}
+			}
+		}
+	}
+	m_counts.shrink_to_fit();
+	return true;
+}
+
+std::uint64_t LayoutCountTable::GetCount(int node, int combo) const
+{
+	if (combo == 0)
+	{
+		return 1;
+	}
+
+	size_t word = static_cast<size_t>(node) * m_maskWords + combo / 64;
+	std::uint64_t bit = std::uint64_t(1) << (combo % 64);
+	if (!(m_masks[word] & bit))
+	{
+		return 0;
+	}
+	return m_counts[m_ranks[word] + std::popcount(m_masks[word] & (bit - 1))];
+}
+
+bool LayoutCountTable::TryPlace(int cell, int length, bool horizontal, Window& window) const
+{
+	int row = cell / m_boardSize;
+	int col = cell % m_boardSize;
+	int endRow = horizontal ? row : row + length - 1;
+	int endCol = horizontal ? col + length - 1 : col;
+	if (endRow >= m_boardSize || endCol >= m_boardSize)
+	{
+		return false;
+	}
+
+	int step = horizontal ? 1 : m_boardSize;
+	for (int k = 0; k < length; k++)
+	{
+		if (window.Test(k * step))
+		{
+			return false;
+		}
+	}
+
+	// Окрестность закрывается только впереди: клетки до текущей уже решены
+	for (int r = row; r <= std::min(endRow + 1, m_boardSize - 1); r++)
+	{
+		for (int c = std::max(col - 1, 0); c <= std::min(endCol + 1, m_boardSize - 1); c++)
+		{
+			int offset = r * m_boardSize + c - cell;
+			if (offset >= 0 && PlacementTables::IsInHalo(m_adjacency, r, c, row, col, endRow, endCol))
+			{
+				window.Set(offset);
+			}
+		}
+	}
+	return true;
+}
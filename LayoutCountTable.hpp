@@ -0,0 +1,117 @@
+﻿#pragma once
+
+#include <vector>
+#include <random>
+#include <cstdint>
+#include "GameBoard.hpp"
+#include "PlacementTables.hpp"
+
+// Число расстановок флота по состояниям перебора FleetSolver: клетки идут
+// по порядку, каждая либо пустая, либо левый верхний конец корабля одной из
+// оставшихся длин, состояние - клетка, окно занятых клеток впереди и
+// оставшиеся корабли. Клетка с окном - узел таблицы: у узла хранятся
+// переходы (корабль каждой длины и ориентации или пустая клетка) и числа
+// расстановок остатка только для тех наборов оставшихся кораблей, которые
+// достижимы из начала поля и дают хотя бы одну расстановку.
+// По таблице расстановка выбирается за один проход по полю: в каждой клетке
+// вариант берется с вероятностью, пропорциональной числу расстановок,
+// которые его продолжают, поэтому все расстановки (корабли одной длины
+// неразличимы) равновероятны, без повторных попыток.
+// Окрестность корабля задается правилом касания, как в PlacementTables.
+// Таблица строится один раз на поле, флот и правило касания и живет до конца программы.
+// Если узлов больше MAX_NODES, чисел больше MAX_ENTRIES, окно не помещается
+// в 128 бит или расстановок больше, чем помещается в 64 бита, Get
+// возвращает nullptr (стандартное поле 10x10 - около 100 тысяч узлов
+// и 3.4 миллиона чисел, около 30 МБ и полсекунды на постройку; 8x8 - 10 тысяч
+// узлов и 190 тысяч чисел).
+class LayoutCountTable
+{
+public:
+	static const int MAX_NODES = 1 << 17;
+	static const long long MAX_ENTRIES = 1 << 22;
+	static const int WINDOW_BITS = 128;
+	static const int MAX_COMBOS = 1 << 12;   // Наборов оставшихся кораблей
+	static constexpr int NO_NODE = -1;
+
+	// Корабль выбранной расстановки
+	struct Pick
+	{
+		int length;
+		int start;
+		bool isHorizontal;
+	};
+
+	// публичные: переопределение типом
+	using ShipSizesType = GameBoard::ShipSizesType;
+	using Adjacency = PlacementTables::Adjacency;
+	using PicksType = std::vector<Pick>;   // В порядке начальных клеток
+
+public:
+	// конструкторы и деконструктор
+	LayoutCountTable(int boardSize, const ShipSizesType& shipSizes, Adjacency adjacency = Adjacency::eNoTouch);
+	~LayoutCountTable() = default;
+
+	// публичные методы
+	static const LayoutCountTable* Get(int boardSize, const ShipSizesType& shipSizes, Adjacency adjacency = Adjacency::eNoTouch);
+	bool Build();
+	void Sample(std::mt19937& random, PicksType& picks) const;
+
+	// геттеры
+	std::uint64_t GetLayoutCount() const { return m_nodeCells.empty() ? 0 : GetCount(0, m_fullCombo); }
+	int GetNodeCount() const { return static_cast<int>(m_nodeCells.size()); }
+	size_t GetEntryCount() const { return m_counts.size(); }
+
+private:
+	// Занятые клетки начиная с текущей: бит 0 - текущая клетка
+	struct Window
+	{
+		std::uint64_t low = 0;
+		std::uint64_t high = 0;
+
+		bool Test(int bit) const { return bit < 64 ? (low >> bit) & 1 : (high >> (bit - 64)) & 1; }
+		void Set(int bit) { (bit < 64 ? low : high) |= std::uint64_t(1) << (bit & 63); }
+		void Shift() { low = (low >> 1) | (high << 63); high >>= 1; }
+	};
+
+	// Узел: первая свободная клетка и окно от нее
+	struct NodeKey
+	{
+		int cell;
+		Window window;
+
+		bool operator==(const NodeKey& other) const
+		{
+			return cell == other.cell && window.low == other.window.low && window.high == other.window.high;
+		}
+	};
+	struct NodeHash
+	{
+		size_t operator()(const NodeKey& key) const;
+	};
+
+	// приватные методы
+	bool DiscoverNodes();
+	bool MarkReachable();
+	bool CountLayouts();
+	std::uint64_t GetCount(int node, int combo) const;
+	bool TryPlace(int cell, int length, bool horizontal, Window& window) const;
+	int GetChild(int node, int option) const { return m_children[static_cast<size_t>(node) * m_optionCount + option]; }
+
+private:
+	// приватные переменные
+	int m_boardSize;
+	Adjacency m_adjacency;
+	std::vector<int> m_lengths;               // Разные длины флота по убыванию
+	std::vector<int> m_lengthCounts;          // Кораблей каждой длины
+	std::vector<int> m_strides;               // Набор оставшихся кораблей - число в смешанной системе счисления
+	std::vector<std::uint32_t> m_available;   // [набор] - биты длин, корабли которых еще остались
+	int m_comboCount;
+	int m_fullCombo;
+	int m_optionCount;                        // 2 * длина + ориентация, последний - пустая клетка
+	int m_maskWords;
+	std::vector<int> m_nodeCells;             // [узел], узлы упорядочены по клеткам
+	std::vector<int> m_children;              // [узел * m_optionCount + вариант], NO_NODE - нельзя
+	std::vector<std::uint64_t> m_masks;       // [узел * m_maskWords + слово] - наборы с ненулевым числом
+	std::vector<std::uint32_t> m_ranks;       // Индекс в m_counts первого числа слова маски
+	std::vector<std::uint64_t> m_counts;
+};
@@ -0,0 +1,237 @@
+﻿#include "LayoutPool.hpp"
+#include <bit>
+#include <cstdint>
+#include <algorithm>
+
+LayoutPool::Ring::Ring(int capacity)
+	: m_mask(std::bit_ceil(static_cast<size_t>(std::max(capacity, 2))) - 1)
+	, m_slots(std::make_unique<Slot[]>(m_mask + 1))
+	, m_enqueue(0)
+	, m_dequeue(0)
+{
+	for (size_t i = 0; i <= m_mask; i++)
+	{
+		m_slots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+}
+
+bool LayoutPool::Ring::TryPush(LayoutType& layout)
+{
+	size_t position = m_enqueue.load(std::memory_order_relaxed);
+	while (true)
+	{
+		Slot& slot = m_slots[position & m_mask];
+		size_t sequence = slot.sequence.load(std::memory_order_acquire);
+		std::intptr_t diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+		if (diff == 0)
+		{
+			// Ячейка свободна - занимаем позицию и пишем в нее
+			if (m_enqueue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				slot.layout.swap(layout);
+				slot.sequence.store(position + 1, std::memory_order_release);
+				return true;
+			}
+		}
+		else if (diff < 0)
+		{
+			// Очередь полна
+			return false;
+		}
+		else
+		{
+			position = m_enqueue.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+bool LayoutPool::Ring::TryPop(LayoutType& layout)
+{
+	size_t position = m_dequeue.load(std::memory_order_relaxed);
+	while (true)
+	{
+		Slot& slot = m_slots[position & m_mask];
+		size_t sequence = slot.sequence.load(std::memory_order_acquire);
+		std::intptr_t diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+		if (diff == 0)
+		{
+			if (m_dequeue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				// Ячейка освободится для писателя следующего круга
+				slot.layout.swap(layout);
+				slot.sequence.store(position + m_mask + 1, std::memory_order_release);
+				return true;
+			}
+		}
+		else if (diff < 0)
+		{
+			// Очередь пуста
+			return false;
+		}
+		else
+		{
+			position = m_dequeue.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+LayoutPool::LayoutPool(int threadCount, int capacity)
+	: m_threadCount(std::max(threadCount, 1))
+	, m_capacity(capacity)
+	, m_running(false)
+	, m_produced(0)
+	, m_popped(0)
+	, m_fallbacks(0)
+	, m_unordered(0)
+	, m_demand(0)
+	, m_waiting(0)
+{
+}
+
+LayoutPool::~LayoutPool()
+{
+	Stop();
+}
+
+int LayoutPool::AddFleet(int boardSize, const ShipSizesType& shipSizes)
+{
+	int fleet = FindFleet(boardSize, shipSizes);
+	if (m_running || fleet != NO_FLEET)
+	{
+		return fleet;
+	}
+	m_fleets.push_back(std::make_unique<Fleet>(Fleet{ boardSize, shipSizes, std::make_unique<Ring>(m_capacity) }));
+	return static_cast<int>(m_fleets.size()) - 1;
+}
+
+void LayoutPool::Start()
+{
+	if (m_running)
+	{
+		return;
+	}
+
+	m_running = true;
+	std::random_device device;
+	for (int thread = 0; thread < m_threadCount; thread++)
+	{
+		m_threads.emplace_back(&LayoutPool::Produce, this, device());
+	}
+}
+
+void LayoutPool::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_waitMutex);
+		m_running = false;
+	}
+	m_demandChanged.notify_all();
+	for (std::thread& thread : m_threads)
+	{
+		thread.join();
+	}
+	m_threads.clear();
+}
+
+bool LayoutPool::TryPop(int fleet, LayoutType& layout)
+{
+	// Флоты не меняются после Start - номер проверяется без блокировки
+	if (fleet < 0 || fleet >= static_cast<int>(m_fleets.size()))
+	{
+		return false;
+	}
+	bool popped = m_fleets[fleet]->ring->TryPop(layout);
+	if (popped)
+	{
+		m_popped.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	// И взятая, и не найденная расстановка - повод достроить буфер
+	NotifyDemand();
+	return popped;
+}
+
+void LayoutPool::NotifyDemand()
+{
+	// Счетчик и число спящих - seq_cst: либо производитель увидит новый счетчик
+	// до сна, либо здесь будет видно, что он спит, и его разбудят под мьютексом
+	m_demand.fetch_add(1);
+	if (m_waiting.load() > 0)
+	{
+		std::lock_guard<std::mutex> lock(m_waitMutex);
+		m_demandChanged.notify_all();
+	}
+}
+
+bool LayoutPool::PlaceFleet(GameBoard& board, int fleet, const ShipSizesType& shipSizes, std::mt19937& random)
+{
+	// Буфер потока переживает вызовы, поэтому обмен с ячейкой не выделяет память
+	thread_local LayoutType layout;
+	if (TryPop(fleet, layout))
+	{
+		for (const FleetGenerator::Placement& placement : layout)
+		{
+			board.PlaceShip(placement.size, placement.start, placement.isHorizontal);
+		}
+		return true;
+	}
+
+	bool ordered = fleet >= 0 && fleet < static_cast<int>(m_fleets.size());
+	(ordered ? m_fallbacks : m_unordered).fetch_add(1, std::memory_order_relaxed);
+	FleetGenerator generator(board.GetSize(), shipSizes);
+	return generator.PlaceFleet(board, random);
+}
+
+int LayoutPool::FindFleet(int boardSize, const ShipSizesType& shipSizes) const
+{
+	for (size_t i = 0; i < m_fleets.size(); i++)
+	{
+		if (m_fleets[i]->boardSize == boardSize && m_fleets[i]->shipSizes == shipSizes)
+		{
+			return static_cast<int>(i);
+		}
+	}
+	return NO_FLEET;
+}
+
+void LayoutPool::Produce(std::uint32_t seed)
+{
+	// У каждого потока свои генераторы, общая только очередь
+	std::mt19937 random(seed);
+	std::vector<FleetGenerator> generators;
+	for (const std::unique_ptr<Fleet>& fleet : m_fleets)
+	{
+		generators.emplace_back(fleet->boardSize, fleet->shipSizes);
+	}
+
+	// Расстановка, не поместившаяся в полный буфер, ждет следующего круга
+	std::vector<LayoutType> layouts(m_fleets.size());
+	std::vector<bool> pending(m_fleets.size(), false);
+	while (m_running.load(std::memory_order_relaxed))
+	{
+		long long demand = m_demand.load();
+		bool pushed = false;
+		for (size_t i = 0; i < m_fleets.size(); i++)
+		{
+			if (!pending[i])
+			{
+				pending[i] = generators[i].Generate(random, layouts[i]);
+			}
+			if (pending[i] && m_fleets[i]->ring->TryPush(layouts[i]))
+			{
+				m_produced.fetch_add(1, std::memory_order_relaxed);
+				pending[i] = false;
+				pushed = true;
+			}
+		}
+
+		// Буферы полны (или расстановки не строятся) - ждем, пока к пулу обратятся
+		if (!pushed)
+		{
+			std::unique_lock<std::mutex> lock(m_waitMutex);
+			m_waiting.fetch_add(1);
+			m_demandChanged.wait(lock, [&] { return !m_running.load(std::memory_order_relaxed) || m_demand.load() != demand; });
+			m_waiting.fetch_sub(1);
+		}
+	}
+}
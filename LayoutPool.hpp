@@ -0,0 +1,115 @@
+﻿#pragma once
+
+#include <vector>
+#include <memory>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+#include "GameBoard.hpp"
+#include "FleetGenerator.hpp"
+
+// Пул готовых расстановок флота для быстрого начала партии. Фоновые потоки
+// заранее строят расстановки для каждого заказанного через AddFleet флота
+// и кладут их в кольцевые буферы без блокировок (несколько писателей и
+// читателей, у каждой ячейки свой номер последовательности). PlaceFleet
+// забирает готовую расстановку за O(1): расстановка меняется местами
+// с буфером ячейки, без копирования и выделения памяти. Если буфер пуст,
+// расстановка строится синхронно генератором игрока, а счетчик промахов
+// пула растет; флот, не заказанный в пуле, считается отдельно. Когда все
+// буферы полны, производители спят на условной переменной, пока игрок
+// не обратится к пулу, и не тратят время процессора. Флот ищется по размеру поля и кораблям один раз (FindFleet),
+// дальше игрок берет расстановки по номеру флота. Расстановки пула не зависят
+// от зерна игрока, поэтому battleship_sim подключает пул только по --pool,
+// и такой прогон не воспроизводится.
+class LayoutPool
+{
+public:
+	static const int DEFAULT_CAPACITY = 1024;   // Расстановок на флот, округляется до степени двойки
+	static const int NO_FLEET = -1;
+
+	// публичные: переопределение типом
+	using LayoutType = FleetGenerator::LayoutType;
+	using ShipSizesType = GameBoard::ShipSizesType;
+
+public:
+	// конструкторы и деконструктор
+	LayoutPool(int threadCount = 1, int capacity = DEFAULT_CAPACITY);
+	~LayoutPool();
+	LayoutPool(const LayoutPool&) = delete;
+	LayoutPool& operator=(const LayoutPool&) = delete;
+
+	// публичные методы
+	int AddFleet(int boardSize, const ShipSizesType& shipSizes);   // Только до Start, возвращает номер флота
+	void Start();
+	void Stop();
+	int FindFleet(int boardSize, const ShipSizesType& shipSizes) const;   // NO_FLEET - флот не заказан
+	bool TryPop(int fleet, LayoutType& layout);
+	bool PlaceFleet(GameBoard& board, int fleet, const ShipSizesType& shipSizes, std::mt19937& random);
+
+	// геттеры
+	long long GetProduced() const { return m_produced.load(std::memory_order_relaxed); }
+	long long GetPopped() const { return m_popped.load(std::memory_order_relaxed); }
+	long long GetFallbacks() const { return m_fallbacks.load(std::memory_order_relaxed); }
+	long long GetUnordered() const { return m_unordered.load(std::memory_order_relaxed); }   // Расстановки флота, которого нет в пуле
+	int GetThreadCount() const { return m_threadCount; }
+
+private:
+	// Ограниченная очередь расстановок без блокировок
+	class Ring
+	{
+	public:
+		// конструкторы и деконструктор
+		Ring(int capacity);
+		~Ring() = default;
+
+		// публичные методы
+		bool TryPush(LayoutType& layout);   // layout получает старый буфер ячейки
+		bool TryPop(LayoutType& layout);
+
+	private:
+		// Ячейка очереди: sequence == позиция - ячейка свободна для записи,
+		// sequence == позиция + 1 - в ней лежит расстановка
+		struct Slot
+		{
+			std::atomic<size_t> sequence;
+			LayoutType layout;
+		};
+
+		// приватные переменные
+		size_t m_mask;
+		std::unique_ptr<Slot[]> m_slots;
+		alignas(64) std::atomic<size_t> m_enqueue;
+		alignas(64) std::atomic<size_t> m_dequeue;
+	};
+
+	// Заказанный флот и его буфер
+	struct Fleet
+	{
+		int boardSize;
+		ShipSizesType shipSizes;
+		std::unique_ptr<Ring> ring;
+	};
+
+	// приватные методы
+	void Produce(std::uint32_t seed);
+	void NotifyDemand();
+
+private:
+	// приватные переменные
+	int m_threadCount;
+	int m_capacity;
+	std::vector<std::unique_ptr<Fleet>> m_fleets;   // Не меняется после Start
+	std::vector<std::thread> m_threads;
+	std::atomic<bool> m_running;
+	std::atomic<long long> m_produced;
+	std::atomic<long long> m_popped;
+	std::atomic<long long> m_fallbacks;
+	std::atomic<long long> m_unordered;
+	std::atomic<long long> m_demand;    // Обращений к пулу: производитель просыпается, когда оно меняется
+	std::atomic<int> m_waiting;         // Производителей, спящих на m_demandChanged
+	std::mutex m_waitMutex;
+	std::condition_variable m_demandChanged;
+};
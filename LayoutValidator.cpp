@@ -0,0 +1,232 @@
+﻿#include "LayoutValidator.hpp"
+#include <thread>
+#include <fstream>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+
+LayoutValidator::LayoutValidator(int boardSize, const ShipSizesType& shipSizes, PlacementTables::Adjacency adjacency)
+	: m_boardSize(boardSize)
+	, m_shipCount(static_cast<int>(shipSizes.size()))
+	, m_wordCount((boardSize * boardSize + BitBoard::WORD_BITS - 1) / BitBoard::WORD_BITS)
+	, m_expectedCounts{}
+	, m_tables{}
+{
+	if (boardSize <= 0 || boardSize > MAX_BOARD_SIZE)
+	{
+		throw std::invalid_argument("Размер поля больше LayoutValidator::MAX_BOARD_SIZE");
+	}
+
+	for (int size : shipSizes)
+	{
+		if (size < 1 || size > boardSize)
+		{
+			throw std::invalid_argument("Длина корабля должна быть от 1 до размера поля");
+		}
+		m_expectedCounts[size]++;
+	}
+
+	// Таблицы позиций всех длин берутся заранее, проверка их не ищет.
+	// Начала позиций таблицы образуют прямоугольник rows x cols, остальные
+	// байты начала (и номера клеток за полем) - выход за край
+	for (int length = 1; length <= boardSize; length++)
+	{
+		for (int orientation = 0; orientation < 2; orientation++)
+		{
+			const PlacementTables::Table& table = PlacementTables::Get(boardSize, length, orientation == 0, adjacency);
+			m_tables[length][orientation] = &table;
+			for (int start = 0; start < 256; start++)
+			{
+				int row = start / boardSize;
+				int col = start % boardSize;
+				m_placements[length][orientation][start] = static_cast<std::int16_t>(
+					row < table.rows && col < table.cols ? table.GetIndex(row, col) : NO_PLACEMENT);
+			}
+		}
+	}
+}
+
+LayoutValidator::Reason LayoutValidator::Validate(const std::uint8_t* layout) const
+{
+	switch (m_wordCount)
+	{
+	case 1:
+		return ValidateWords<1>(layout);
+	case 2:
+		return ValidateWords<2>(layout);
+	case 3:
+		return ValidateWords<3>(layout);
+	default:
+		return ValidateWords<4>(layout);
+	}
+}
+
+template <int WORDS>
+LayoutValidator::Reason LayoutValidator::ValidateWords(const std::uint8_t* layout) const
+{
+	WordType occupied[WORDS] = {};
+	WordType blocked[WORDS] = {};
+	LengthCountsType counts{};
+
+	for (int ship = 0; ship < m_shipCount; ship++)
+	{
+		int start = layout[ship * BYTES_PER_SHIP];
+		int shape = layout[ship * BYTES_PER_SHIP + 1];
+		int length = shape & LENGTH_MASK;
+		if (length < 1 || length > m_boardSize)
+		{
+			return Reason::eBadLength;
+		}
+
+		int orientation = (shape & HORIZONTAL_FLAG) ? 0 : 1;
+		int placement = m_placements[length][orientation][start];
+		if (placement == NO_PLACEMENT)
+		{
+			return Reason::eOutOfBounds;
+		}
+
+		const PlacementTables::Table& table = *m_tables[length][orientation];
+		const WordType* footprint = table.GetFootprint(placement);
+		const WordType* halo = table.GetHalo(placement);
+		WordType overlap = 0;
+		WordType touching = 0;
+		for (int word = 0; word < WORDS; word++)
+		{
+			overlap |= footprint[word] & occupied[word];
+			touching |= footprint[word] & blocked[word];
+		}
+		if (overlap)
+		{
+			return Reason::eOverlap;
+		}
+		if (touching)
+		{
+			return Reason::eTouching;
+		}
+
+		for (int word = 0; word < WORDS; word++)
+		{
+			occupied[word] |= footprint[word];
+			blocked[word] |= halo[word];
+		}
+		counts[length]++;
+	}
+
+	return counts == m_expectedCounts ? Reason::eValid : Reason::eFleetMismatch;
+}
+
+template <int WORDS>
+void LayoutValidator::ValidateRange(const std::uint8_t* records, Reason* reasons, long long count) const
+{
+	size_t recordSize = GetRecordSize();
+	for (long long layout = 0; layout < count; layout++)
+	{
+		reasons[layout] = ValidateWords<WORDS>(records + layout * recordSize);
+	}
+}
+
+void LayoutValidator::ValidateBatch(std::span<const std::uint8_t> records, std::span<Reason> reasons, int threadCount) const
+{
+	size_t recordSize = GetRecordSize();
+	long long layoutCount = static_cast<long long>(std::min(records.size() / recordSize, reasons.size()));
+	threadCount = std::max(1, std::min<int>(threadCount, static_cast<int>(std::max(layoutCount, 1LL))));
+
+	// Все расстановки стоят одинаково, поэтому хватает равных непрерывных диапазонов
+	auto worker = [&](int self)
+	{
+		long long begin = layoutCount * self / threadCount;
+		long long end = layoutCount * (self + 1) / threadCount;
+		const std::uint8_t* first = records.data() + begin * recordSize;
+		switch (m_wordCount)
+		{
+		case 1:
+			ValidateRange<1>(first, reasons.data() + begin, end - begin);
+			break;
+		case 2:
+			ValidateRange<2>(first, reasons.data() + begin, end - begin);
+			break;
+		case 3:
+			ValidateRange<3>(first, reasons.data() + begin, end - begin);
+			break;
+		default:
+			ValidateRange<4>(first, reasons.data() + begin, end - begin);
+			break;
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (int i = 1; i < threadCount; i++)
+	{
+		threads.emplace_back(worker, i);
+	}
+	worker(0);
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+}
+
+const char* LayoutValidator::GetReasonName(Reason reason)
+{
+	switch (reason)
+	{
+	case Reason::eValid:
+		return "допустима";
+	case Reason::eBadLength:
+		return "неверная длина корабля";
+	case Reason::eOutOfBounds:
+		return "корабль за краем поля";
+	case Reason::eOverlap:
+		return "корабли пересекаются";
+	case Reason::eTouching:
+		return "корабли касаются";
+	case Reason::eFleetMismatch:
+		return "состав флота не совпадает";
+	default:
+		return "неизвестная причина";
+	}
+}
+
+void LayoutValidator::EncodeLayout(const FleetGenerator::LayoutType& layout, RecordsType& records)
+{
+	for (const FleetGenerator::Placement& placement : layout)
+	{
+		records.push_back(static_cast<std::uint8_t>(placement.start.GetIndex()));
+		records.push_back(static_cast<std::uint8_t>(placement.size | (placement.isHorizontal ? HORIZONTAL_FLAG : 0)));
+	}
+}
+
+bool LayoutValidator::ReadFile(const std::string& path, int& boardSize, int& shipCount, RecordsType& records)
+{
+	std::ifstream file(path, std::ios::binary);
+	FileHeader header{};
+	if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+		std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0 || header.version != FILE_VERSION ||
+		header.shipCount == 0)
+	{
+		return false;
+	}
+	boardSize = header.boardSize;
+	shipCount = header.shipCount;
+
+	// Записи читаются одним блоком; неполная последняя запись отбрасывается
+	file.seekg(0, std::ios::end);
+	std::streamoff bytes = static_cast<std::streamoff>(file.tellg()) - static_cast<std::streamoff>(sizeof(header));
+	file.seekg(sizeof(header), std::ios::beg);
+	size_t recordSize = static_cast<size_t>(shipCount) * BYTES_PER_SHIP;
+	records.resize(static_cast<size_t>(std::max<std::streamoff>(bytes, 0)) / recordSize * recordSize);
+	return static_cast<bool>(file.read(reinterpret_cast<char*>(records.data()), records.size()));
+}
+
+bool LayoutValidator::WriteFile(const std::string& path, int boardSize, int shipCount, const RecordsType& records)
+{
+	std::ofstream file(path, std::ios::binary);
+	FileHeader header{};
+	std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+	header.version = FILE_VERSION;
+	header.boardSize = static_cast<std::uint8_t>(boardSize);
+	header.shipCount = static_cast<std::uint8_t>(shipCount);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(records.data()), records.size());
+	return static_cast<bool>(file);
+}
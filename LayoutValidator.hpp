@@ -0,0 +1,101 @@
+﻿#pragma once
+
+#include <array>
+#include <vector>
+#include <string>
+#include <span>
+#include <cstdint>
+#include "GameBoard.hpp"
+#include "BitBoard.hpp"
+#include "PlacementTables.hpp"
+#include "FleetGenerator.hpp"
+
+// Пакетная проверка расстановок флота, присланных игроками. Расстановка
+// хранится компактно - по два байта на корабль: номер начальной клетки и
+// длина | HORIZONTAL_FLAG (как в BoardSnapshot). Корабль проверяется по
+// маскам PlacementTables: выход за край, пересечение с уже поставленными
+// (маска клеток) и касание (маска окрестности по правилу касания), затем
+// состав флота сравнивается с заданным. Поле не строится, поэтому на
+// расстановку уходит несколько десятков операций над словами: номер позиции
+// берется по байту начала из готовой таблицы, а число слов маски - параметр
+// шаблона, выбранный один раз на пакет.
+// Файл расстановок: заголовок FileHeader, затем записи подряд.
+class LayoutValidator
+{
+public:
+	static const int MAX_BOARD_SIZE = 16;             // Номер клетки помещается в байт
+	static const int MAX_WORDS = (MAX_BOARD_SIZE * MAX_BOARD_SIZE + BitBoard::WORD_BITS - 1) / BitBoard::WORD_BITS;
+	static const int BYTES_PER_SHIP = 2;
+	static const int NO_PLACEMENT = -1;
+	static const std::uint8_t HORIZONTAL_FLAG = 0x80;
+	static const std::uint8_t LENGTH_MASK = 0x7F;
+	static const std::uint8_t FILE_VERSION = 1;
+	static constexpr char FILE_MAGIC[4] = { 'B', 'S', 'L', 'Y' };
+
+	// Причина отказа; у допустимой расстановки - eValid
+	enum class Reason : std::uint8_t
+	{
+		eValid = 0,
+		eBadLength = 1,      // Длина корабля 0 или больше размера поля
+		eOutOfBounds = 2,    // Корабль выходит за край поля
+		eOverlap = 3,        // Корабль пересекает другой
+		eTouching = 4,       // Корабль касается другого вопреки правилу касания
+		eFleetMismatch = 5   // Длины кораблей не совпадают с флотом
+	};
+	static const int REASON_COUNT = 6;
+
+	// Заголовок файла расстановок
+	struct FileHeader
+	{
+		char magic[4];
+		std::uint8_t version;
+		std::uint8_t boardSize;
+		std::uint8_t shipCount;
+		std::uint8_t reserved;
+	};
+
+	// публичные: переопределение типом
+	using WordType = BitBoard::WordType;
+	using ShipSizesType = GameBoard::ShipSizesType;
+	using RecordsType = std::vector<std::uint8_t>;   // Записи расстановок подряд
+	using ReasonsType = std::vector<Reason>;
+
+public:
+	// конструкторы и деконструктор
+	LayoutValidator(int boardSize, const ShipSizesType& shipSizes,
+		PlacementTables::Adjacency adjacency = PlacementTables::Adjacency::eNoTouch);
+	~LayoutValidator() = default;
+
+	// публичные методы
+	Reason Validate(const std::uint8_t* layout) const;
+	void ValidateBatch(std::span<const std::uint8_t> records, std::span<Reason> reasons, int threadCount) const;
+	static const char* GetReasonName(Reason reason);
+	static void EncodeLayout(const FleetGenerator::LayoutType& layout, RecordsType& records);
+	static bool ReadFile(const std::string& path, int& boardSize, int& shipCount, RecordsType& records);
+	static bool WriteFile(const std::string& path, int boardSize, int shipCount, const RecordsType& records);
+
+	// геттеры
+	int GetBoardSize() const { return m_boardSize; }
+	int GetShipCount() const { return m_shipCount; }
+	int GetRecordSize() const { return m_shipCount * BYTES_PER_SHIP; }
+
+private:
+	// приватные: переопределение типом
+	using LengthCountsType = std::array<std::uint8_t, MAX_BOARD_SIZE + 1>;
+	using TablesType = std::array<std::array<const PlacementTables::Table*, 2>, MAX_BOARD_SIZE + 1>;
+	using PlacementsType = std::array<std::array<std::array<std::int16_t, 256>, 2>, MAX_BOARD_SIZE + 1>;
+
+	// приватные методы
+	template <int WORDS>
+	Reason ValidateWords(const std::uint8_t* layout) const;
+	template <int WORDS>
+	void ValidateRange(const std::uint8_t* records, Reason* reasons, long long count) const;
+
+	// приватные переменные
+	int m_boardSize;
+	int m_shipCount;
+	int m_wordCount;
+	LengthCountsType m_expectedCounts;   // Кораблей каждой длины во флоте
+	TablesType m_tables;                 // [длина][0 - горизонтально, 1 - вертикально]
+	PlacementsType m_placements;         // [длина][ориентация][байт начала] - номер позиции или NO_PLACEMENT
+};
@@ -1,14 +1,34 @@
 ﻿#include <iostream>
 #include <locale>
+#include <limits>
 #include "GameManager.hpp"
 #include "UserInterface.hpp"
+#include "LayoutPool.hpp"
+#include "FleetSolver.hpp"
 
 int main()
 {
-    while (true) {
-        // Устанавливаем локаль для поддержки русского языка
-        setlocale(LC_ALL, "Russian");
+    const int BOARD_SIZE = 10;
+    const int LAYOUT_POOL_CAPACITY = 16;   // Партии идут по одной - хватает нескольких готовых расстановок
+
+    // Устанавливаем локаль для поддержки русского языка
+    setlocale(LC_ALL, "Russian");
+
+    // Флот проверяется до настройки партии: если он не помещается на поле,
+    // игра не начинается. Ответ сохраняется в кэше FleetSolver, следующий запуск читает его из файла
+    FleetSolver fleetSolver(BOARD_SIZE, GameBoard::MakeFleetSizes(BOARD_SIZE));
+    if (fleetSolver.SolveCached(false).feasibility == FleetSolver::Feasibility::eInfeasible)
+    {
+        std::cerr << "Флот не помещается на поле " << BOARD_SIZE << "x" << BOARD_SIZE << "\n";
+        return 1;
+    }
 
+    // Расстановки для автоматической расстановки строятся в фоне, пока игрок читает правила
+    LayoutPool layoutPool(1, LAYOUT_POOL_CAPACITY);
+    layoutPool.AddFleet(BOARD_SIZE, GameBoard::MakeFleetSizes(BOARD_SIZE));
+    layoutPool.Start();
+
+    while (true) {
         std::cout << "========================================\n";
         std::cout << "           МОРСКОЙ БОЙ\n";
         std::cout << "========================================\n";
@@ -21,12 +41,26 @@ int main()
         std::cout << "  3 корабля - 2 клетки\n";
         std::cout << "  4 корабля - 1 клетка\n";
         std::cout << "- Вы можете выбрать ручную или автоматическую расстановку\n";
+        std::cout << "- В режиме залпа за ход делается столько выстрелов,\n";
+        std::cout << "  сколько у стреляющего осталось непотопленных кораблей\n";
         std::cout << "========================================\n\n";
 
         try
         {
-            const int BOARD_SIZE = 10;
-            GameManager gameManager(BOARD_SIZE);
+            // Выбор режима игры
+            int mode = 0;
+            while (mode != 1 && mode != 2)
+            {
+                std::cout << "Режим игры (1 - классический, 2 - залп): ";
+                if (!(std::cin >> mode))
+                {
+                    std::cin.clear();
+                    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                }
+            }
+
+            GameManager gameManager(BOARD_SIZE,
+                mode == 2 ? GameManager::GameMode::eSalvo : GameManager::GameMode::eClassic, &layoutPool);
 
             // Настройка игры
             gameManager.SetupGame();
@@ -0,0 +1,66 @@
+﻿#include "MatchEngine.hpp"
+
+MatchEngine::MatchEngine(bool recordTurns)
+	: m_recordTurns(recordTurns)
+{
+}
+
+const MatchResult& MatchEngine::Run(AIPlayer& first, AIPlayer& second)
+{
+	m_result.winner = MatchResult::NO_WINNER;
+	m_result.shotCount = 0;
+	m_result.placementFailed = false;
+	m_result.turns.clear();
+
+	// Без флота игрок проиграл бы сразу - такая партия не играется
+	if (!first.TryPlaceShips() || !second.TryPlaceShips())
+	{
+		m_result.placementFailed = true;
+		return m_result;
+	}
+
+	first.SetEnemyBoard(&second.GetMyBoard());
+	second.SetEnemyBoard(&first.GetMyBoard());
+
+	// Каждый игрок не может сделать больше выстрелов, чем клеток на поле,
+	// поэтому зацикливание ИИ прерываем после этого предела
+	long long boardCells = static_cast<long long>(first.GetMyBoard().GetSize()) * first.GetMyBoard().GetSize();
+	long long maxShots = 2 * boardCells;
+	if (m_recordTurns)
+	{
+		m_result.turns.reserve(maxShots);
+	}
+
+	AIPlayer* players[2] = { &first, &second };
+	int current = 0;
+
+	while (m_result.shotCount < maxShots)
+	{
+		AIPlayer* player = players[current];
+
+		Player::MoveType move = player->MakeMove();
+		GameBoard* enemyBoard = player->GetEnemyBoard();
+		Ship::ShotResult result = enemyBoard->ReceiveShot(move);
+		player->UpdateAIState(result, move);
+
+		m_result.shotCount++;
+		if (m_recordTurns)
+		{
+			m_result.turns.push_back(result);
+		}
+
+		if (enemyBoard->IsAllShipsSunk())
+		{
+			m_result.winner = current;
+			break;
+		}
+
+		// Смена хода если не попадание
+		if (result != Ship::ShotResult::eHit && result != Ship::ShotResult::eSunk)
+		{
+			current = 1 - current;
+		}
+	}
+
+	return m_result;
+}
@@ -0,0 +1,40 @@
+﻿#pragma once
+
+#include "AIPlayer.hpp"
+#include <vector>
+#include <cstdint>
+
+// Итог одной партии без ввода-вывода
+struct MatchResult
+{
+	using TurnsType = std::vector<Ship::ShotResult>;
+
+	static const int NO_WINNER = -1;
+
+	int winner = NO_WINNER;   // 0 - первый игрок, 1 - второй, NO_WINNER - партия прервана
+	bool placementFailed = false;   // Флот одного из игроков не расставился, партия не начиналась
+	long long shotCount = 0;  // Общее число выстрелов обоих игроков
+	TurnsType turns;          // Результат каждого выстрела по порядку
+};
+
+// Безголовый движок партий ИИ против ИИ.
+// Правила совпадают с GameManager::RunGameLoop: попадание дает право
+// на следующий выстрел, промах передает ход сопернику.
+class MatchEngine
+{
+public:
+	// конструкторы и деконструктор
+	MatchEngine(bool recordTurns = true);
+	~MatchEngine() = default;
+
+	// публичные методы
+	const MatchResult& Run(AIPlayer& first, AIPlayer& second);
+
+	// геттеры
+	const MatchResult& GetResult() const { return m_result; }
+
+private:
+	// приватные переменные
+	bool m_recordTurns;
+	MatchResult m_result;
+};
@@ -0,0 +1,426 @@
+﻿#include "PlacementIndex.hpp"
+#include "PlacementTables.hpp"
+#include <map>
+#include <mutex>
+#include <utility>
+#include <algorithm>
+#include <bit>
+
+PlacementIndex::PlacementIndex(int boardSize, const ShipCountsType& shipCounts, bool trackDensity)
+	: m_layout(GetSharedLayout(boardSize, static_cast<int>(shipCounts.size()) - 1))
+	, m_trackDensity(trackDensity)
+	, m_shipCounts(shipCounts)
+	, m_alive(m_layout->starts.size(), 1)
+	, m_open(boardSize * boardSize, 1)
+	, m_density(boardSize * boardSize, 0)
+	, m_leafCount(1)
+	, m_dirty(boardSize * boardSize, 0)
+	, m_targetScores(boardSize * boardSize, 0)
+	, m_visited(m_layout->starts.size(), 0)
+	, m_visitStamp(0)
+{
+	if (!m_trackDensity)
+	{
+		return;
+	}
+
+	// Начальная плотность: все расстановки живы
+	for (int placement = 0; placement < static_cast<int>(m_alive.size()); placement++)
+	{
+		int weight = m_shipCounts[m_layout->lengths[placement]];
+		for (int i = 0; i < m_layout->lengths[placement] && weight > 0; i++)
+		{
+			m_density[PlacementCell(placement, i)] += weight;
+		}
+	}
+
+	// Дерево отрезков над клетками для выбора максимума за O(log N)
+	int cellCount = boardSize * boardSize;
+	while (m_leafCount < cellCount)
+	{
+		m_leafCount *= 2;
+	}
+	m_treeMax.assign(2 * m_leafCount, -1);
+	m_treeTies.assign(2 * m_leafCount, 0);
+	m_nodeDirty.assign(m_leafCount, 0);
+	for (int cell = 0; cell < cellCount; cell++)
+	{
+		m_treeMax[m_leafCount + cell] = m_density[cell];
+		m_treeTies[m_leafCount + cell] = 1;
+	}
+	for (int node = m_leafCount - 1; node >= 1; node--)
+	{
+		UpdateNode(node);
+	}
+}
+
+std::shared_ptr<const PlacementIndex::Layout> PlacementIndex::GetSharedLayout(int boardSize, int maxLength)
+{
+	// Индекс строится один раз на размер поля и флот и разделяется между потоками
+	static std::mutex mutex;
+	static std::map<std::pair<int, int>, std::shared_ptr<const Layout>> layouts;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	auto& layout = layouts[{ boardSize, maxLength }];
+	if (!layout)
+	{
+		layout = BuildLayout(boardSize, maxLength);
+	}
+	return layout;
+}
+
+std::shared_ptr<const PlacementIndex::Layout> PlacementIndex::BuildLayout(int boardSize, int maxLength)
+{
+	auto layout = std::make_shared<Layout>();
+	layout->boardSize = boardSize;
+	layout->maxLength = std::max(maxLength, 0);
+	layout->lengthOffsets.assign(layout->maxLength + 2, 0);
+
+	// Все расстановки, сгруппированные по длине корабля, с масками из таблиц позиций
+	std::vector<std::pair<const PlacementTables::Table*, int>> sources;
+	for (int length = 1; length <= layout->maxLength; length++)
+	{
+		layout->lengthOffsets[length] = static_cast<int>(layout->starts.size());
+		for (bool horizontal : { true, false })
+		{
+			// Однопалубный корабль не имеет ориентации
+			if (length == 1 && !horizontal)
+			{
+				continue;
+			}
+
+			const PlacementTables::Table& table = PlacementTables::Get(boardSize, length, horizontal);
+			for (int index = 0; index < table.GetCount(); index++)
+			{
+				layout->starts.push_back(table.GetStart(index));
+				layout->lengths.push_back(static_cast<std::uint8_t>(length));
+				layout->horizontal.push_back(horizontal);
+				sources.push_back({ &table, index });
+			}
+		}
+	}
+	layout->lengthOffsets[layout->maxLength + 1] = static_cast<int>(layout->starts.size());
+
+	// Обходит клетки расстановки (cover) и ее соседей (touch) по битам масок
+	auto forEachCell = [&](int placement, auto&& onCover, auto&& onTouch)
+	{
+		const PlacementTables::Table& table = *sources[placement].first;
+		const PlacementTables::WordType* footprint = table.GetFootprint(sources[placement].second);
+		const PlacementTables::WordType* halo = table.GetHalo(sources[placement].second);
+
+		for (int word = 0; word < table.wordCount; word++)
+		{
+			for (PlacementTables::WordType bits = halo[word]; bits != 0; bits &= bits - 1)
+			{
+				int bit = std::countr_zero(bits);
+				int cell = word * BitBoard::WORD_BITS + bit;
+				if ((footprint[word] >> bit) & 1)
+				{
+					onCover(cell);
+				}
+				else
+				{
+					onTouch(cell);
+				}
+			}
+		}
+	};
+
+	// Списки расстановок по клеткам в формате CSR: подсчет, затем заполнение
+	int cellCount = boardSize * boardSize;
+	int placementCount = static_cast<int>(layout->starts.size());
+	layout->coverOffsets.assign(cellCount + 1, 0);
+	layout->touchOffsets.assign(cellCount + 1, 0);
+	for (int placement = 0; placement < placementCount; placement++)
+	{
+		forEachCell(placement,
+			[&](int cell) { layout->coverOffsets[cell + 1]++; },
+			[&](int cell) { layout->touchOffsets[cell + 1]++; });
+	}
+	for (int cell = 0; cell < cellCount; cell++)
+	{
+		layout->coverOffsets[cell + 1] += layout->coverOffsets[cell];
+		layout->touchOffsets[cell + 1] += layout->touchOffsets[cell];
+	}
+
+	layout->coverIds.resize(layout->coverOffsets[cellCount]);
+	layout->touchIds.resize(layout->touchOffsets[cellCount]);
+	std::vector<int> coverFill(layout->coverOffsets.begin(), layout->coverOffsets.end() - 1);
+	std::vector<int> touchFill(layout->touchOffsets.begin(), layout->touchOffsets.end() - 1);
+	for (int placement = 0; placement < placementCount; placement++)
+	{
+		forEachCell(placement,
+			[&](int cell) { layout->coverIds[coverFill[cell]++] = placement; },
+			[&](int cell) { layout->touchIds[touchFill[cell]++] = placement; });
+	}
+
+	return layout;
+}
+
+int PlacementIndex::PlacementCell(int placement, int i) const
+{
+	int step = m_layout->horizontal[placement] ? 1 : m_layout->boardSize;
+	return m_layout->starts[placement] + i * step;
+}
+
+void PlacementIndex::KillPlacement(int placement)
+{
+	if (!m_alive[placement])
+	{
+		return;
+	}
+	m_alive[placement] = 0;
+
+	int weight = m_shipCounts[m_layout->lengths[placement]];
+	if (!m_trackDensity || weight == 0)
+	{
+		return;
+	}
+
+	for (int i = 0; i < m_layout->lengths[placement]; i++)
+	{
+		int cell = PlacementCell(placement, i);
+		m_density[cell] -= weight;
+		MarkDirty(cell);
+	}
+}
+
+void PlacementIndex::CloseCell(int cell)
+{
+	if (m_open[cell])
+	{
+		m_open[cell] = 0;
+		if (m_trackDensity)
+		{
+			MarkDirty(cell);
+		}
+	}
+}
+
+void PlacementIndex::ReleaseCell(int cell)
+{
+	// Клетка, выбранная в залп, снова доступна, пока не пришел результат выстрела
+	if (!m_open[cell])
+	{
+		m_open[cell] = 1;
+		if (m_trackDensity)
+		{
+			MarkDirty(cell);
+		}
+	}
+}
+
+void PlacementIndex::MarkDirty(int cell)
+{
+	// За один выстрел плотность клетки меняется многократно,
+	// поэтому дерево обновляется один раз перед выбором хода
+	if (!m_dirty[cell])
+	{
+		m_dirty[cell] = 1;
+		m_dirtyCells.push_back(cell);
+	}
+}
+
+void PlacementIndex::UpdateNode(int node)
+{
+	int left = 2 * node;
+	int right = left + 1;
+	m_treeMax[node] = std::max(m_treeMax[left], m_treeMax[right]);
+	m_treeTies[node] = (m_treeMax[left] == m_treeMax[node] ? m_treeTies[left] : 0)
+		+ (m_treeMax[right] == m_treeMax[node] ? m_treeTies[right] : 0);
+}
+
+void PlacementIndex::FlushTree()
+{
+	// Листья дерева лежат на одной глубине, поэтому узлы обновляются
+	// по уровням снизу вверх, каждый общий предок - один раз
+	m_treeLevel.clear();
+	for (int cell : m_dirtyCells)
+	{
+		m_dirty[cell] = 0;
+
+		int node = m_leafCount + cell;
+		m_treeMax[node] = m_open[cell] ? m_density[cell] : -1;
+		m_treeTies[node] = m_open[cell] ? 1 : 0;
+		if (!m_nodeDirty[node / 2])
+		{
+			m_nodeDirty[node / 2] = 1;
+			m_treeLevel.push_back(node / 2);
+		}
+	}
+	m_dirtyCells.clear();
+
+	while (!m_treeLevel.empty())
+	{
+		m_treeParents.clear();
+		for (int node : m_treeLevel)
+		{
+			m_nodeDirty[node] = 0;
+			UpdateNode(node);
+			if (node > 1 && !m_nodeDirty[node / 2])
+			{
+				m_nodeDirty[node / 2] = 1;
+				m_treeParents.push_back(node / 2);
+			}
+		}
+		m_treeLevel.swap(m_treeParents);
+	}
+}
+
+void PlacementIndex::MarkEmpty(int cell)
+{
+	// Промах или клетка рядом с потопленным кораблем: накрывающие ее расстановки невозможны
+	CloseCell(cell);
+	for (int i = m_layout->coverOffsets[cell]; i < m_layout->coverOffsets[cell + 1]; i++)
+	{
+		KillPlacement(m_layout->coverIds[i]);
+	}
+}
+
+void PlacementIndex::MarkHit(int cell)
+{
+	// Корабли не касаются друг друга: расстановки, соседние с попаданием, невозможны
+	CloseCell(cell);
+	for (int i = m_layout->touchOffsets[cell]; i < m_layout->touchOffsets[cell + 1]; i++)
+	{
+		KillPlacement(m_layout->touchIds[i]);
+	}
+}
+
+void PlacementIndex::MarkSunk(const CellsType& shipCells)
+{
+	// Потопленный корабль учтен, все расстановки через его клетки и рядом с ними снимаются
+	for (int cell : shipCells)
+	{
+		CloseCell(cell);
+		for (int i = m_layout->coverOffsets[cell]; i < m_layout->coverOffsets[cell + 1]; i++)
+		{
+			KillPlacement(m_layout->coverIds[i]);
+		}
+		for (int i = m_layout->touchOffsets[cell]; i < m_layout->touchOffsets[cell + 1]; i++)
+		{
+			KillPlacement(m_layout->touchIds[i]);
+		}
+	}
+
+	// Кораблей этой длины стало меньше - вес оставшихся расстановок уменьшается на единицу
+	int length = static_cast<int>(shipCells.size());
+	if (length > m_layout->maxLength || m_shipCounts[length] == 0)
+	{
+		return;
+	}
+
+	m_shipCounts[length]--;
+	if (!m_trackDensity)
+	{
+		return;
+	}
+
+	for (int placement = m_layout->lengthOffsets[length]; placement < m_layout->lengthOffsets[length + 1]; placement++)
+	{
+		if (!m_alive[placement])
+		{
+			continue;
+		}
+		for (int i = 0; i < length; i++)
+		{
+			int cell = PlacementCell(placement, i);
+			m_density[cell]--;
+			MarkDirty(cell);
+		}
+	}
+}
+
+int PlacementIndex::SelectHuntCell(std::mt19937& random)
+{
+	if (!m_trackDensity)
+	{
+		return -1;
+	}
+
+	FlushTree();
+	if (m_treeMax[1] < 0)
+	{
+		return -1;
+	}
+
+	// Спуск по дереву к k-й клетке с максимальной плотностью
+	unsigned k = random() % static_cast<unsigned>(m_treeTies[1]);
+	int node = 1;
+	while (node < m_leafCount)
+	{
+		int left = 2 * node;
+		if (m_treeMax[left] == m_treeMax[node])
+		{
+			if (k < static_cast<unsigned>(m_treeTies[left]))
+			{
+				node = left;
+				continue;
+			}
+			k -= m_treeTies[left];
+		}
+		node = left + 1;
+	}
+	return node - m_leafCount;
+}
+
+int PlacementIndex::SelectTargetCell(const CellsType& hitCells, std::mt19937& random)
+{
+	// Новая метка обхода, чтобы не сбрасывать массив посещений
+	if (++m_visitStamp == 0)
+	{
+		std::fill(m_visited.begin(), m_visited.end(), 0);
+		m_visitStamp = 1;
+	}
+
+	// Считаем только живые расстановки, проходящие через незавершенные попадания
+	for (int hit : hitCells)
+	{
+		for (int i = m_layout->coverOffsets[hit]; i < m_layout->coverOffsets[hit + 1]; i++)
+		{
+			int placement = m_layout->coverIds[i];
+			if (!m_alive[placement] || m_visited[placement] == m_visitStamp)
+			{
+				continue;
+			}
+			m_visited[placement] = m_visitStamp;
+
+			int weight = m_shipCounts[m_layout->lengths[placement]];
+			for (int j = 0; j < m_layout->lengths[placement] && weight > 0; j++)
+			{
+				int cell = PlacementCell(placement, j);
+				if (!m_open[cell])
+				{
+					continue;
+				}
+				if (m_targetScores[cell] == 0)
+				{
+					m_touchedCells.push_back(cell);
+				}
+				m_targetScores[cell] += weight;
+			}
+		}
+	}
+
+	// Лучшая клетка, равные варианты выбираем случайно
+	int best = 0;
+	int bestCell = -1;
+	unsigned ties = 0;
+	for (int cell : m_touchedCells)
+	{
+		if (m_targetScores[cell] > best)
+		{
+			best = m_targetScores[cell];
+			bestCell = cell;
+			ties = 1;
+		}
+		else if (m_targetScores[cell] == best && random() % ++ties == 0)
+		{
+			bestCell = cell;
+		}
+		m_targetScores[cell] = 0;
+	}
+	m_touchedCells.clear();
+
+	return bestCell;
+}
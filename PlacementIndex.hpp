@@ -0,0 +1,84 @@
+﻿#pragma once
+
+#include <vector>
+#include <memory>
+#include <random>
+#include <cstdint>
+
+// Индекс возможных расстановок кораблей для ИИ.
+// Для каждой клетки хранит списки расстановок, которые ее накрывают или
+// касаются. Выстрел затрагивает только эти расстановки, поэтому плотность
+// клеток обновляется пошагово, без пересчета всего поля.
+class PlacementIndex
+{
+public:
+	// публичные: переопределение типом
+	using CellsType = std::vector<int>;
+	using ShipCountsType = std::vector<int>;
+
+	// Неизменяемая часть индекса, общая для всех игроков с тем же размером поля
+	struct Layout
+	{
+		int boardSize = 0;
+		int maxLength = 0;
+		std::vector<int> starts;               // Первая клетка расстановки
+		std::vector<std::uint8_t> lengths;     // Длина корабля
+		std::vector<std::uint8_t> horizontal;  // Ориентация
+		std::vector<int> lengthOffsets;        // Расстановки длины L: [lengthOffsets[L], lengthOffsets[L + 1])
+		std::vector<int> coverOffsets;         // Расстановки, накрывающие клетку (CSR)
+		std::vector<int> coverIds;
+		std::vector<int> touchOffsets;         // Расстановки, касающиеся клетки (CSR)
+		std::vector<int> touchIds;
+	};
+
+public:
+	// конструкторы и деконструктор
+	PlacementIndex(int boardSize, const ShipCountsType& shipCounts, bool trackDensity = true);
+	~PlacementIndex() = default;
+
+	// публичные методы
+	void MarkEmpty(int cell);
+	void MarkHit(int cell);
+	void MarkSunk(const CellsType& shipCells);
+	void ReserveCell(int cell) { CloseCell(cell); }
+	void ReleaseCell(int cell);
+	int SelectHuntCell(std::mt19937& random);
+	int SelectTargetCell(const CellsType& hitCells, std::mt19937& random);
+
+	// геттеры
+	int GetDensity(int cell) const { return m_density[cell]; }
+	bool IsAlive(int placement) const { return m_alive[placement] != 0; }
+	const Layout& GetLayout() const { return *m_layout; }
+
+private:
+	// приватные методы
+	static std::shared_ptr<const Layout> GetSharedLayout(int boardSize, int maxLength);
+	static std::shared_ptr<const Layout> BuildLayout(int boardSize, int maxLength);
+	int PlacementCell(int placement, int i) const;
+	void KillPlacement(int placement);
+	void CloseCell(int cell);
+	void MarkDirty(int cell);
+	void UpdateNode(int node);
+	void FlushTree();
+
+private:
+	// приватные переменные
+	std::shared_ptr<const Layout> m_layout;
+	bool m_trackDensity;               // Вести плотность и дерево для SelectHuntCell
+	ShipCountsType m_shipCounts;       // Непотопленные корабли по длине (вес расстановки)
+	std::vector<std::uint8_t> m_alive;
+	std::vector<std::uint8_t> m_open;  // Клетка еще может быть целью выстрела
+	std::vector<int> m_density;        // Сумма весов живых расстановок через клетку
+	int m_leafCount;
+	std::vector<int> m_treeMax;        // Дерево отрезков: максимум плотности среди открытых клеток
+	std::vector<int> m_treeTies;       // и число клеток с этим максимумом
+	std::vector<std::uint8_t> m_dirty; // Клетки, чья плотность изменилась с последнего обновления дерева
+	std::vector<int> m_dirtyCells;
+	std::vector<std::uint8_t> m_nodeDirty;
+	std::vector<int> m_treeLevel;
+	std::vector<int> m_treeParents;
+	std::vector<int> m_targetScores;   // Рабочие буферы режима добивания
+	std::vector<int> m_touchedCells;
+	std::vector<std::uint32_t> m_visited;
+	std::uint32_t m_visitStamp;
+};
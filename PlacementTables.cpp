@@ -0,0 +1,174 @@
+﻿#include "PlacementTables.hpp"
+#include "GameBoard.hpp"
+#include "RuleSet.hpp"
+#include "Ship.hpp"
+#include <map>
+#include <array>
+#include <mutex>
+#include <vector>
+#include <tuple>
+#include <memory>
+#include <utility>
+#include <algorithm>
+
+static_assert(PlacementTables::STANDARD_BOARD_SIZE == GameBoard::DEFAULT_BOARD_SIZE,
+	"Таблицы при компиляции строятся для стандартного поля");
+static_assert(PlacementTables::STANDARD_MAX_LENGTH >= GameBoard::DEFAULT_SHIP_CONFIG[0].first,
+	"Таблицы при компиляции должны покрывать все корабли стандартного флота");
+static_assert(PlacementTables::STANDARD_MAX_LENGTH >= RuleTraits<HasbroRules>::MAX_LENGTH &&
+	PlacementTables::STANDARD_MAX_LENGTH >= RuleTraits<DiagonalRules>::MAX_LENGTH,
+	"Таблицы при компиляции должны покрывать флоты всех наборов правил");
+static_assert(PlacementTables::SizeTables::MAX_LENGTH == Ship::MAX_SIZE, "SizeTables должен покрывать все длины кораблей");
+
+namespace
+{
+	using Adjacency = PlacementTables::Adjacency;
+	using LengthTablesType = std::array<std::array<PlacementTables::Table, 2>, PlacementTables::STANDARD_MAX_LENGTH>;
+	using StaticTablesType = std::array<LengthTablesType, PlacementTables::ADJACENCY_COUNT>;
+
+	// [длина - 1][0 - горизонтально, 1 - вертикально]
+	template <int N, Adjacency ADJACENCY>
+	constexpr LengthTablesType MakeLengthTables()
+	{
+		return { {
+			{ PlacementTables::StaticTable<N, 1, true, ADJACENCY>::MakeTable(), PlacementTables::StaticTable<N, 1, false, ADJACENCY>::MakeTable() },
+			{ PlacementTables::StaticTable<N, 2, true, ADJACENCY>::MakeTable(), PlacementTables::StaticTable<N, 2, false, ADJACENCY>::MakeTable() },
+			{ PlacementTables::StaticTable<N, 3, true, ADJACENCY>::MakeTable(), PlacementTables::StaticTable<N, 3, false, ADJACENCY>::MakeTable() },
+			{ PlacementTables::StaticTable<N, 4, true, ADJACENCY>::MakeTable(), PlacementTables::StaticTable<N, 4, false, ADJACENCY>::MakeTable() },
+			{ PlacementTables::StaticTable<N, 5, true, ADJACENCY>::MakeTable(), PlacementTables::StaticTable<N, 5, false, ADJACENCY>::MakeTable() }
+		} };
+	}
+
+	// [правило касания][длина - 1][ориентация]
+	template <int N>
+	constexpr StaticTablesType MakeStaticTables()
+	{
+		return { {
+			MakeLengthTables<N, Adjacency::eNoTouch>(),
+			MakeLengthTables<N, Adjacency::eDiagonal>(),
+			MakeLengthTables<N, Adjacency::eTouch>()
+		} };
+	}
+
+	// Стандартное поле и остальные размеры, для которых есть BoardCore<N>
+	constexpr StaticTablesType TABLES_8 = MakeStaticTables<8>();
+	constexpr StaticTablesType TABLES_10 = MakeStaticTables<10>();
+	constexpr StaticTablesType TABLES_12 = MakeStaticTables<12>();
+	constexpr StaticTablesType TABLES_16 = MakeStaticTables<16>();
+
+	const StaticTablesType* FindStaticTables(int boardSize)
+	{
+		switch (boardSize)
+		{
+		case 8:
+			return &TABLES_8;
+		case 10:
+			return &TABLES_10;
+		case 12:
+			return &TABLES_12;
+		case 16:
+			return &TABLES_16;
+		default:
+			return nullptr;
+		}
+	}
+
+	// Таблица нестандартного размера вместе с памятью под маски
+	struct OwnedTable
+	{
+		PlacementTables::Table table;
+		std::vector<PlacementTables::WordType> footprints;
+		std::vector<PlacementTables::WordType> halos;
+	};
+}
+
+const PlacementTables::Table& PlacementTables::Get(int boardSize, int length, bool horizontal, Adjacency adjacency)
+{
+	const StaticTablesType* tables = FindStaticTables(boardSize);
+	if (tables && length >= 1 && length <= STANDARD_MAX_LENGTH)
+	{
+		return (*tables)[static_cast<int>(adjacency)][length - 1][horizontal ? 0 : 1];
+	}
+	return BuildTable(boardSize, length, horizontal, adjacency);
+}
+
+const PlacementTables::SizeTables& PlacementTables::GetSizeTables(int boardSize, Adjacency adjacency)
+{
+	static std::mutex mutex;
+	static std::map<std::pair<int, Adjacency>, std::unique_ptr<SizeTables>> cache;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	std::unique_ptr<SizeTables>& tables = cache[{ boardSize, adjacency }];
+	if (!tables)
+	{
+		tables = std::make_unique<SizeTables>(boardSize, adjacency);
+	}
+	return *tables;
+}
+
+const PlacementTables::Table& PlacementTables::SizeTables::Resolve(int length, bool horizontal) const
+{
+	// Два потока могут найти таблицу одновременно - оба запишут один и тот же указатель
+	const Table& table = PlacementTables::Get(m_boardSize, length, horizontal, m_adjacency);
+	m_tables[length - 1][horizontal ? 0 : 1].store(&table, std::memory_order_release);
+	return table;
+}
+
+const PlacementTables::Table& PlacementTables::BuildTable(int boardSize, int length, bool horizontal, Adjacency adjacency)
+{
+	static std::mutex mutex;
+	static std::map<std::tuple<int, int, bool, Adjacency>, std::unique_ptr<OwnedTable>> cache;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	std::unique_ptr<OwnedTable>& owned = cache[{ boardSize, length, horizontal, adjacency }];
+	if (owned)
+	{
+		return owned->table;
+	}
+
+	owned = std::make_unique<OwnedTable>();
+	Table& table = owned->table;
+	table.boardSize = boardSize;
+	table.length = length;
+	table.horizontal = horizontal;
+	table.adjacency = adjacency;
+	table.rows = std::max(horizontal ? boardSize : boardSize - length + 1, 0);
+	table.cols = std::max(horizontal ? boardSize - length + 1 : boardSize, 0);
+	table.wordCount = (boardSize * boardSize + BitBoard::WORD_BITS - 1) / BitBoard::WORD_BITS;
+	if (length <= 0)
+	{
+		table.rows = 0;
+	}
+
+	owned->footprints.assign(static_cast<size_t>(table.GetCount()) * table.wordCount, 0);
+	owned->halos.assign(static_cast<size_t>(table.GetCount()) * table.wordCount, 0);
+	for (int index = 0; index < table.GetCount(); index++)
+	{
+		int row = index / table.cols;
+		int col = index % table.cols;
+		int endRow = horizontal ? row : row + length - 1;
+		int endCol = horizontal ? col + length - 1 : col;
+		size_t offset = static_cast<size_t>(index) * table.wordCount;
+
+		for (int r = std::max(row - 1, 0); r <= std::min(endRow + 1, boardSize - 1); r++)
+		{
+			for (int c = std::max(col - 1, 0); c <= std::min(endCol + 1, boardSize - 1); c++)
+			{
+				int cell = r * boardSize + c;
+				WordType bit = WordType(1) << (cell % BitBoard::WORD_BITS);
+				if (IsInHalo(adjacency, r, c, row, col, endRow, endCol))
+				{
+					owned->halos[offset + cell / BitBoard::WORD_BITS] |= bit;
+				}
+				if (r >= row && r <= endRow && c >= col && c <= endCol)
+				{
+					owned->footprints[offset + cell / BitBoard::WORD_BITS] |= bit;
+				}
+			}
+		}
+	}
+
+	table.footprints = owned->footprints.data();
+	table.halos = owned->halos.data();
+	return table;
+}
@@ -0,0 +1,159 @@
+﻿#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include "BitBoard.hpp"
+
+// Таблицы позиций корабля. Для каждой длины и ориентации перечислены все
+// начальные клетки, и для каждой позиции хранятся две битовые маски поля:
+// клетки корабля и клетки корабля вместе с окрестностью. Окрестность задается
+// правилом касания: без касаний, касание углами или вплотную.
+// Для стандартного поля и полей 8, 12 и 16 (размеры BoardCore<N>) таблицы
+// строятся при компиляции, для остальных размеров - при первом обращении,
+// и дальше живут до конца программы. Get для таких размеров ищет таблицу под
+// блокировкой, поэтому горячий код берет SizeTables поля один раз и дальше
+// читает таблицы через него.
+class PlacementTables
+{
+public:
+	static const int STANDARD_BOARD_SIZE = 10;   // GameBoard::DEFAULT_BOARD_SIZE
+	static const int STANDARD_MAX_LENGTH = 5;    // Самый длинный корабль наборов правил RuleSet.hpp
+	static const int ADJACENCY_COUNT = 3;
+
+	// Какие клетки вокруг корабля закрыты для других кораблей
+	enum class Adjacency
+	{
+		eNoTouch,    // Корабли не касаются даже углами
+		eDiagonal,   // Касание углами разрешено, сторонами - нет
+		eTouch       // Корабли могут стоять вплотную
+	};
+
+	// публичные: переопределение типом
+	using WordType = BitBoard::WordType;
+
+	// Позиции одной длины и ориентации: начала образуют прямоугольник rows x cols
+	struct Table
+	{
+		int boardSize = 0;
+		int length = 0;
+		bool horizontal = true;
+		Adjacency adjacency = Adjacency::eNoTouch;
+		int rows = 0;
+		int cols = 0;
+		int wordCount = 0;
+		const WordType* footprints = nullptr;  // [index * wordCount + word]
+		const WordType* halos = nullptr;
+
+		int GetCount() const { return rows * cols; }
+		int GetIndex(int row, int col) const { return row * cols + col; }
+		int GetStart(int index) const { return (index / cols) * boardSize + index % cols; }
+		const WordType* GetFootprint(int index) const { return footprints + index * wordCount; }
+		const WordType* GetHalo(int index) const { return halos + index * wordCount; }
+	};
+
+	// Таблица, вычисляемая при компиляции
+	template <int N, int LENGTH, bool HORIZONTAL, Adjacency ADJACENCY = Adjacency::eNoTouch>
+	struct StaticTable
+	{
+		static constexpr int WORDS = (N * N + BitBoard::WORD_BITS - 1) / BitBoard::WORD_BITS;
+		static constexpr int ROWS = HORIZONTAL ? N : N - LENGTH + 1;
+		static constexpr int COLS = HORIZONTAL ? N - LENGTH + 1 : N;
+		static constexpr int COUNT = ROWS * COLS;
+
+		using MasksType = std::array<WordType, COUNT * WORDS>;
+
+		static constexpr MasksType BuildMasks(bool withHalo)
+		{
+			MasksType masks{};
+			for (int row = 0; row < ROWS; row++)
+			{
+				for (int col = 0; col < COLS; col++)
+				{
+					int endRow = HORIZONTAL ? row : row + LENGTH - 1;
+					int endCol = HORIZONTAL ? col + LENGTH - 1 : col;
+					int margin = withHalo ? 1 : 0;
+					for (int r = row - margin; r <= endRow + margin; r++)
+					{
+						for (int c = col - margin; c <= endCol + margin; c++)
+						{
+							if (r >= 0 && r < N && c >= 0 && c < N &&
+								IsInHalo(ADJACENCY, r, c, row, col, endRow, endCol))
+							{
+								int cell = r * N + c;
+								masks[(row * COLS + col) * WORDS + cell / BitBoard::WORD_BITS] |=
+									WordType(1) << (cell % BitBoard::WORD_BITS);
+							}
+						}
+					}
+				}
+			}
+			return masks;
+		}
+
+		static constexpr MasksType FOOTPRINTS = BuildMasks(false);
+		static constexpr MasksType HALOS = BuildMasks(true);
+
+		static constexpr Table MakeTable()
+		{
+			return Table{ N, LENGTH, HORIZONTAL, ADJACENCY, ROWS, COLS, WORDS, FOOTPRINTS.data(), HALOS.data() };
+		}
+	};
+
+	// Таблицы всех длин одного размера поля и правила касания. Указатель на таблицу
+	// длины запоминается при первом обращении и дальше читается без блокировки
+	class SizeTables
+	{
+	public:
+		static const int MAX_LENGTH = 32;   // Ship::MAX_SIZE
+
+		SizeTables(int boardSize, Adjacency adjacency)
+			: m_boardSize(boardSize)
+			, m_adjacency(adjacency)
+		{
+		}
+
+		const Table& Get(int length, bool horizontal) const
+		{
+			if (length < 1 || length > MAX_LENGTH)
+			{
+				return PlacementTables::Get(m_boardSize, length, horizontal, m_adjacency);
+			}
+			const Table* table = m_tables[length - 1][horizontal ? 0 : 1].load(std::memory_order_acquire);
+			return table ? *table : Resolve(length, horizontal);
+		}
+
+	private:
+		const Table& Resolve(int length, bool horizontal) const;
+
+		int m_boardSize;
+		Adjacency m_adjacency;
+		mutable std::array<std::array<std::atomic<const Table*>, 2>, MAX_LENGTH> m_tables{};
+	};
+
+public:
+	// публичные методы
+	static const Table& Get(int boardSize, int length, bool horizontal, Adjacency adjacency = Adjacency::eNoTouch);
+	static const SizeTables& GetSizeTables(int boardSize, Adjacency adjacency = Adjacency::eNoTouch);
+
+	// Клетка (r, c) рамки на единицу вокруг корабля [row..endRow] x [col..endCol]
+	// входит в его окрестность; клетки самого корабля входят всегда
+	static constexpr bool IsInHalo(Adjacency adjacency, int r, int c, int row, int col, int endRow, int endCol)
+	{
+		bool inRows = r >= row && r <= endRow;
+		bool inCols = c >= col && c <= endCol;
+		switch (adjacency)
+		{
+		case Adjacency::eDiagonal:
+			return inRows || inCols;
+		case Adjacency::eTouch:
+			return inRows && inCols;
+		default:
+			return true;
+		}
+	}
+
+private:
+	// приватные методы
+	static const Table& BuildTable(int boardSize, int length, bool horizontal, Adjacency adjacency);
+};
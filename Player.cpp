@@ -1,8 +1,37 @@
-#include "Player.hpp"
+﻿#include "Player.hpp"
+#include "LayoutPool.hpp"
+#include <algorithm>
 
-Player::Player(std::string name, int boardSize)
+Player::Player(std::string name, int boardSize, GameBoard::Adjacency adjacency)
 	: m_name(name)
-	, m_myBoard(boardSize)
+	, m_myBoard(boardSize, adjacency)
 	, m_enemyBoard(nullptr)
+	, m_layoutPool(nullptr)
+	, m_layoutFleet(LayoutPool::NO_FLEET)
 {
-}
\ No newline at end of file
+}
+
+void Player::SetLayoutPool(LayoutPool* pool)
+{
+	// Флот в пуле ищется один раз, а не при каждой расстановке.
+	// Пул строит флот GameBoard::MakeFleetSizes без касаний - поле
+	// с другим правилом касания расставляется своим генератором
+	int boardSize = m_myBoard.GetSize();
+	m_layoutPool = pool;
+	m_layoutFleet = pool && m_myBoard.GetAdjacency() == RussianRules::ADJACENCY
+		? pool->FindFleet(boardSize, GameBoard::MakeFleetSizes(boardSize)) : LayoutPool::NO_FLEET;
+}
+
+void Player::MakeSalvo(int shotCount, SalvoType& salvo)
+{
+	// По умолчанию залп - несколько обычных ходов, повторы отбрасываются
+	salvo.clear();
+	for (int shot = 0; shot < shotCount; shot++)
+	{
+		MoveType move = MakeMove();
+		if (std::find(salvo.begin(), salvo.end(), move) == salvo.end())
+		{
+			salvo.push_back(move);
+		}
+	}
+}
@@ -1,26 +1,33 @@
 ﻿#pragma once
 
 #include <string>
-#include <utility>
+#include <vector>
+#include "Cell.hpp"
 #include "GameBoard.hpp"
 
+// Предварительное объявление
+class LayoutPool;
+
 class Player
 {
 public:
 	// публичные: переопределение типом
-	using MoveType = std::pair<int, int>;
+	using MoveType = WideCell;
+	using SalvoType = std::vector<MoveType>;
 
 public:
 	// конструкторы и деконструктор
-	Player(std::string name, int boardSize);
+	Player(std::string name, int boardSize, GameBoard::Adjacency adjacency = RussianRules::ADJACENCY);
 	virtual ~Player() = default;
 
 	// публичные методы
 	virtual void PlaceShips() = 0;
 	virtual MoveType MakeMove() = 0;
+	virtual void MakeSalvo(int shotCount, SalvoType& salvo);
 
 	// геттеры и сеттеры
 	void SetEnemyBoard(GameBoard* board) { m_enemyBoard = board; }
+	void SetLayoutPool(LayoutPool* pool);   // nullptr - расстановка строится при вызове
 	GameBoard& GetMyBoard() { return m_myBoard; }
 	GameBoard* GetEnemyBoard() { return m_enemyBoard; }
 	std::string GetName() const { return m_name; }
@@ -30,4 +37,6 @@ protected:
 	std::string m_name;
 	GameBoard m_myBoard;
 	GameBoard* m_enemyBoard;
+	LayoutPool* m_layoutPool;
+	int m_layoutFleet;   // Номер флота игрока в пуле
 };
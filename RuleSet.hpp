@@ -0,0 +1,269 @@
+﻿#pragma once
+
+#include <array>
+#include <utility>
+#include <vector>
+#include <string>
+#include "BoardCore.hpp"
+#include "PlacementTables.hpp"
+
+// Наборы правил - типы-политики: размер поля, флот и правило касания
+// известны при компиляции. Набор правил - структура с полями BOARD_SIZE,
+// ADJACENCY и SHIP_CONFIG ({длина, количество}). RuleTraits<Rules>
+// выводит из него флот и тип ядра поля BoardCore<BOARD_SIZE, ADJACENCY>:
+// ядро, собранное под набор правил, не проверяет правила во время игры.
+// Правило касания принимают также FleetGenerator, LayoutValidator
+// и FleetSolver. Для партии правила выбираются во время работы (RuleChoice):
+// GameBoard выбирает ядро с нужным правилом касания, AIPlayer ставит флот
+// правил и отмечает окрестность потопленного корабля по правилу касания,
+// MatchEngine правил не знает - ход переходит одинаково при любых.
+// Стратегии плотности (density, mcmc) рассчитаны на корабли без касаний
+// и доступны только при таком правиле.
+// При компиляции флот проверяется жадной расстановкой (RuleChecks::CanPlaceGreedy).
+
+// Русские правила: поле 10x10, 4-3-3-2-2-2-1-1-1-1, корабли не касаются
+struct RussianRules
+{
+	static const int BOARD_SIZE = 10;
+	static constexpr PlacementTables::Adjacency ADJACENCY = PlacementTables::Adjacency::eNoTouch;
+	static constexpr std::array<std::pair<int, int>, 4> SHIP_CONFIG = {
+		{{ 4, 1 }, { 3, 2 }, { 2, 3 }, { 1, 4 }}
+	};
+};
+
+// Правила Hasbro: поле 10x10, 5-4-3-3-2, корабли могут стоять вплотную
+struct HasbroRules
+{
+	static const int BOARD_SIZE = 10;
+	static constexpr PlacementTables::Adjacency ADJACENCY = PlacementTables::Adjacency::eTouch;
+	static constexpr std::array<std::pair<int, int>, 4> SHIP_CONFIG = {
+		{{ 5, 1 }, { 4, 1 }, { 3, 2 }, { 2, 1 }}
+	};
+};
+
+// Русский флот, но корабли могут касаться углами
+struct DiagonalRules
+{
+	static const int BOARD_SIZE = 10;
+	static constexpr PlacementTables::Adjacency ADJACENCY = PlacementTables::Adjacency::eDiagonal;
+	static constexpr std::array<std::pair<int, int>, 4> SHIP_CONFIG = RussianRules::SHIP_CONFIG;
+};
+
+// Набор правил во время работы: поле, флот (от длинных к коротким) и правило касания
+struct RuleChoice
+{
+	int boardSize;
+	std::vector<int> shipSizes;
+	PlacementTables::Adjacency adjacency;
+
+	template <class Rules>
+	static RuleChoice Make();
+	static bool Parse(const std::string& name, RuleChoice& rules);   // russian, hasbro или diagonal
+};
+
+// Вычисления над набором правил, пригодные для static_assert
+class RuleChecks
+{
+public:
+	// публичные: переопределение типом
+	using Adjacency = PlacementTables::Adjacency;
+
+public:
+	// публичные методы
+	template <class Rules>
+	static constexpr int CountShips()
+	{
+		int count = 0;
+		for (const auto& [length, ships] : Rules::SHIP_CONFIG)
+		{
+			count += ships;
+		}
+		return count;
+	}
+
+	template <class Rules>
+	static constexpr int CountShipCells()
+	{
+		int cells = 0;
+		for (const auto& [length, ships] : Rules::SHIP_CONFIG)
+		{
+			cells += length * ships;
+		}
+		return cells;
+	}
+
+	template <class Rules>
+	static constexpr int GetMaxLength()
+	{
+		int maxLength = 0;
+		for (const auto& [length, ships] : Rules::SHIP_CONFIG)
+		{
+			maxLength = ships > 0 && length > maxLength ? length : maxLength;
+		}
+		return maxLength;
+	}
+
+	template <class Rules>
+	static constexpr bool HasValidLengths()
+	{
+		for (const auto& [length, ships] : Rules::SHIP_CONFIG)
+		{
+			if (ships < 0 || (ships > 0 && (length < 1 || length > Rules::BOARD_SIZE)))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Жадная расстановка: от длинных кораблей к коротким, каждый в первую
+	// свободную позицию. Условие только достаточное: если она удалась,
+	// расстановка флота существует; если нет, флот все равно может помещаться
+	// (точный ответ дает FleetSolver во время работы).
+	template <class Rules>
+	static constexpr bool CanPlaceGreedy()
+	{
+		if (!HasValidLengths<Rules>())
+		{
+			return false;
+		}
+
+		constexpr int n = Rules::BOARD_SIZE;
+		std::array<bool, n * n> occupied{};
+		for (int length = n; length >= 1; length--)
+		{
+			for (const auto& [shipLength, ships] : Rules::SHIP_CONFIG)
+			{
+				for (int ship = 0; shipLength == length && ship < ships; ship++)
+				{
+					if (!PlaceFirstFit<n>(Rules::ADJACENCY, length, occupied))
+					{
+						return false;
+					}
+				}
+			}
+		}
+		return true;
+	}
+
+private:
+	// приватные методы
+	template <int N>
+	static constexpr bool PlaceFirstFit(Adjacency adjacency, int length, std::array<bool, N * N>& occupied)
+	{
+		for (int start = 0; start < N * N; start++)
+		{
+			for (bool horizontal : { true, false })
+			{
+				int row = start / N;
+				int col = start % N;
+				int endRow = horizontal ? row : row + length - 1;
+				int endCol = horizontal ? col + length - 1 : col;
+				if (endRow >= N || endCol >= N || IsBlocked<N>(adjacency, row, col, endRow, endCol, occupied))
+				{
+					continue;
+				}
+
+				for (int r = row; r <= endRow; r++)
+				{
+					for (int c = col; c <= endCol; c++)
+					{
+						occupied[r * N + c] = true;
+					}
+				}
+				return true;
+			}
+		}
+		return false;
+	}
+
+	template <int N>
+	static constexpr bool IsBlocked(Adjacency adjacency, int row, int col, int endRow, int endCol,
+		const std::array<bool, N * N>& occupied)
+	{
+		for (int r = row - 1; r <= endRow + 1; r++)
+		{
+			for (int c = col - 1; c <= endCol + 1; c++)
+			{
+				if (r >= 0 && r < N && c >= 0 && c < N && occupied[r * N + c] &&
+					PlacementTables::IsInHalo(adjacency, r, c, row, col, endRow, endCol))
+				{
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+};
+
+// Флот и тип поля набора правил
+template <class Rules>
+class RuleTraits
+{
+public:
+	static const int BOARD_SIZE = Rules::BOARD_SIZE;
+	static constexpr PlacementTables::Adjacency ADJACENCY = Rules::ADJACENCY;
+	static const int SHIP_COUNT = RuleChecks::CountShips<Rules>();
+	static const int SHIP_CELLS = RuleChecks::CountShipCells<Rules>();
+	static const int MAX_LENGTH = RuleChecks::GetMaxLength<Rules>();
+
+	// публичные: переопределение типом
+	using CoreType = BoardCore<BOARD_SIZE, ADJACENCY>;
+	using ShipSizesType = std::array<int, SHIP_COUNT>;   // От длинных к коротким, как в SHIP_CONFIG
+
+	static_assert(BOARD_SIZE > 0, "Набор правил задает поле фиксированного размера");
+	static_assert(SHIP_COUNT > 0, "Во флоте должен быть хотя бы один корабль");
+	static_assert(RuleChecks::HasValidLengths<Rules>(), "Длина корабля должна быть от 1 до размера поля");
+	static_assert(SHIP_CELLS <= BOARD_SIZE * BOARD_SIZE, "Клеток флота больше, чем клеток поля");
+	static_assert(SHIP_COUNT <= CoreType::MAX_SHIPS, "Кораблей больше, чем допускает правило касания");
+	static_assert(RuleChecks::CanPlaceGreedy<Rules>(),
+		"Флот не расставляется жадно по правилу касания (проверка только достаточная: возможно, он помещается - проверьте FleetSolver)");
+
+	static constexpr ShipSizesType MakeShipSizes()
+	{
+		ShipSizesType sizes{};
+		int next = 0;
+		for (const auto& [length, ships] : Rules::SHIP_CONFIG)
+		{
+			for (int ship = 0; ship < ships; ship++)
+			{
+				sizes[next++] = length;
+			}
+		}
+		return sizes;
+	}
+
+	static constexpr ShipSizesType SHIP_SIZES = MakeShipSizes();
+};
+
+template <class Rules>
+RuleChoice RuleChoice::Make()
+{
+	const auto& sizes = RuleTraits<Rules>::SHIP_SIZES;
+	return { Rules::BOARD_SIZE, std::vector<int>(sizes.begin(), sizes.end()), Rules::ADJACENCY };
+}
+
+inline bool RuleChoice::Parse(const std::string& name, RuleChoice& rules)
+{
+	if (name == "russian")
+	{
+		rules = Make<RussianRules>();
+	}
+	else if (name == "hasbro")
+	{
+		rules = Make<HasbroRules>();
+	}
+	else if (name == "diagonal")
+	{
+		rules = Make<DiagonalRules>();
+	}
+	else
+	{
+		return false;
+	}
+	return true;
+}
+
+static_assert(RuleTraits<RussianRules>::SHIP_CELLS == 20, "Русский флот - 20 палуб");
+static_assert(RuleTraits<HasbroRules>::SHIP_CELLS == 17, "Флот Hasbro - 17 палуб");
+static_assert(RuleTraits<DiagonalRules>::SHIP_COUNT == 10, "Флот с касанием углами - русский");
@@ -1,44 +1,28 @@
 ﻿#include "Ship.hpp"
 
-Ship::Ship(int size, std::pair<int, int> startCoord, bool isHorizontal)
-	: m_size(size)
+Ship::Ship(int size, WideCell start, bool isHorizontal, int boardSize)
+	: m_start(start)
+	, m_step(static_cast<std::uint16_t>(isHorizontal ? 1 : boardSize))
+	, m_size(static_cast<std::uint8_t>(size))
 	, m_isHorizontal(isHorizontal)
-	, m_hits(size, false)
+	, m_hits(0)
 {
-	m_coordinates.clear();
-
-	// Генерация всех координат корабля
-	for (int i = 0; i < m_size; i++)
+	// Попадания хранятся битами, поэтому длина корабля ограничена
+	if (size <= 0 || size > MAX_SIZE)
 	{
-		if (m_isHorizontal)
-		{
-			m_coordinates.push_back({ startCoord.first, startCoord.second + i });
-		}
-		else
-		{
-			m_coordinates.push_back({ startCoord.first + i, startCoord.second });
-		}
+		throw std::invalid_argument("Недопустимая длина корабля");
 	}
 }
 
-bool Ship::IsSunk() const
+bool Ship::TakeHit(WideCell cell)
 {
-	for (bool hit : m_hits)
+	// Номер палубы - смещение от начала в шагах корабля
+	int offset = cell.GetIndex() - m_start.GetIndex();
+	if (offset < 0 || offset % m_step != 0 || offset / m_step >= m_size)
 	{
-		if (!hit) return false;
+		return false;
 	}
+
+	m_hits |= HitsType(1) << (offset / m_step);
 	return true;
 }
-
-bool Ship::TakeHit(std::pair<int, int> coord)
-{
-	for (int i = 0; i < m_size; i++)
-	{
-		if (m_coordinates[i] == coord)
-		{
-			m_hits[i] = true;
-			return true;
-		}
-	}
-	return false;
-}
\ No newline at end of file
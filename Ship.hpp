@@ -1,17 +1,19 @@
 ﻿#pragma once
 
-#include <vector>
-#include <utility>
+#include <iterator>
 #include <stdexcept>
+#include <cstdint>
+#include "Cell.hpp"
 
+// Корабль: начальная клетка, длина, шаг между палубами и маска попаданий.
+// Клетки палуб не хранятся, а вычисляются при обходе (начало + номер * шаг),
+// поэтому корабль занимает несколько байт и копируется без выделения памяти.
 class Ship
 {
 public:
-	// публичные: переопределение типом
-	using CoordinatesType = std::vector<std::pair<int, int>>;
-	using HitsType = std::vector<bool>;
+	static const int MAX_SIZE = 32;   // Разрядность маски попаданий
 
-	enum class ShotResult
+	enum class ShotResult : std::uint8_t
 	{
 		eMiss = 0,
 		eHit = 1,
@@ -19,24 +21,75 @@ public:
 		eAlreadyShot = 3
 	};
 
+	// публичные: переопределение типом
+	using CoordType = WideCell;   // Корабль бывает и на большом поле
+	using HitsType = std::uint32_t;
+
+	// Обход клеток корабля от начальной
+	class CoordinateIterator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = CoordType;
+		using difference_type = std::ptrdiff_t;
+		using pointer = void;
+		using reference = CoordType;
+
+		CoordinateIterator(const Ship* ship, int index) : m_ship(ship), m_index(index) {}
+
+		CoordType operator*() const { return m_ship->GetCoordinate(m_index); }
+		CoordinateIterator& operator++() { m_index++; return *this; }
+		CoordinateIterator operator++(int) { CoordinateIterator old = *this; m_index++; return old; }
+		bool operator==(const CoordinateIterator& other) const { return m_index == other.m_index; }
+		bool operator!=(const CoordinateIterator& other) const { return m_index != other.m_index; }
+
+	private:
+		const Ship* m_ship;
+		int m_index;
+	};
+
+	// Диапазон клеток корабля для range-for
+	class CoordinatesType
+	{
+	public:
+		explicit CoordinatesType(const Ship* ship) : m_ship(ship) {}
+
+		CoordinateIterator begin() const { return CoordinateIterator(m_ship, 0); }
+		CoordinateIterator end() const { return CoordinateIterator(m_ship, m_ship->GetSize()); }
+		int size() const { return m_ship->GetSize(); }
+		CoordType front() const { return m_ship->GetStart(); }
+
+	private:
+		const Ship* m_ship;
+	};
+
 public:
 	// конструкторы и деконструктор
-	Ship(int size, std::pair<int, int> startCoord, bool isHorizontal);
+	Ship(int size, WideCell start, bool isHorizontal, int boardSize);
 	~Ship() = default;
 
 	// публичные методы
-	bool IsSunk() const;
-	bool TakeHit(std::pair<int, int> coord);
+	bool IsSunk() const { return m_hits == FullMask(); }
+	bool TakeHit(WideCell cell);
+	bool IsHit(int index) const { return (m_hits >> index) & 1; }
+	CoordType GetCoordinate(int index) const { return WideCell(m_start.GetIndex() + index * m_step); }
 
 	// геттеры
-	const CoordinatesType& GetCoordinates() const { return m_coordinates; }
+	CoordinatesType GetCoordinates() const { return CoordinatesType(this); }
+	CoordType GetStart() const { return m_start; }
 	int GetSize() const { return m_size; }
 	bool GetIsHorizontal() const { return m_isHorizontal; }
+	HitsType GetHits() const { return m_hits; }
+
+private:
+	// приватные методы
+	HitsType FullMask() const { return m_size == MAX_SIZE ? ~HitsType(0) : (HitsType(1) << m_size) - 1; }
 
 private:
 	// приватные переменные
-	int m_size;
-	CoordinatesType m_coordinates;
-	HitsType m_hits;
+	WideCell m_start;
+	std::uint16_t m_step;   // 1 для горизонтального, размер поля для вертикального
+	std::uint8_t m_size;
 	bool m_isHorizontal;
-};
\ No newline at end of file
+	HitsType m_hits;
+};
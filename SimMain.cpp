@@ -0,0 +1,1264 @@
+﻿#include <iostream>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <map>
+#include <vector>
+#include <span>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include "Tournament.hpp"
+#include "DensityKernel.hpp"
+#include "FleetSampler.hpp"
+#include "FleetGenerator.hpp"
+#include "RuleSet.hpp"
+#include "LayoutPool.hpp"
+#include "LayoutValidator.hpp"
+#include "FleetSolver.hpp"
+#include "KnowledgeBoard.hpp"
+
+// battleship_sim - прогон партий ИИ против ИИ без ввода-вывода
+// Параметры:
+//   --games N    число партий (по умолчанию 100000)
+//   --size N     размер поля (по умолчанию GameBoard::DEFAULT_BOARD_SIZE)
+//   --seed S     зерно турнира (по умолчанию 1)
+//   --threads T  число потоков (по умолчанию - все ядра)
+//   --out FILE   файл с итогом каждой партии
+//   --ai1 NAME, --ai2 NAME  стратегии игроков: random, density или mcmc
+//   --rules NAME набор правил партии: russian, hasbro или diagonal (задает поле и флот
+//                вместо --size; density и mcmc - только без касаний)
+//   --mcmc-samples N  выборок на выстрел добивания mcmc (по умолчанию AIPlayer::DEFAULT_SAMPLER_SAMPLES)
+//   --mcmc-chains C   цепей выборки mcmc (по умолчанию 1)
+//   --mcmc-threads T  потоков выборки mcmc внутри хода (по умолчанию 1: турнир уже занимает все ядра)
+//   --pool       брать расстановки из LayoutPool с одним фоновым потоком (прогон перестает
+//                воспроизводиться: расстановки пула не зависят от зерна)
+//   --selfcheck  сверить быстрые реализации с эталонными и выйти
+//   --sampler-bench  измерить скорость FleetSampler (выборок в секунду) и выйти
+//   --layout-bench   измерить скорость FleetGenerator (расстановок в секунду) и выйти
+//   --salvo-bench    сравнить залп через ReceiveShots с отдельными вызовами ReceiveShot и выйти
+//   --pool-bench     сравнить начало партии с пулом расстановок LayoutPool и без него и выйти
+//   --fleet-info     проверить, помещается ли флот на поле --size, посчитать расстановки и выйти
+//   --fleet-cache FILE  файл кэша FleetSolver. Для --fleet-info по умолчанию
+//                FleetSolver::DEFAULT_CACHE_PATH; проверка поля перед турниром
+//                пишет в кэш только с этим параметром
+namespace
+{
+	bool ParseStrategy(const std::string& name, AIPlayer::Strategy& strategy)
+	{
+		if (name == "random")
+		{
+			strategy = AIPlayer::Strategy::eRandomHunt;
+		}
+		else if (name == "density")
+		{
+			strategy = AIPlayer::Strategy::eProbabilityDensity;
+		}
+		else if (name == "mcmc")
+		{
+			strategy = AIPlayer::Strategy::eMonteCarlo;
+		}
+		else
+		{
+			return false;
+		}
+		return true;
+	}
+
+	// Сверка векторного ядра плотности с эталонным перебором на случайных полях
+	bool CheckDensityKernel(std::mt19937& random, long long iterations)
+	{
+		const DensityKernel::Backend backends[] = {
+			DensityKernel::Backend::eSSE2, DensityKernel::Backend::eAVX2
+		};
+
+		long long mismatches = 0;
+		for (long long i = 0; i < iterations; i++)
+		{
+			int boardSize = 1 + random() % DensityKernel::MAX_BOARD_SIZE;
+			DensityKernel::RowMasksType rows;
+			for (auto& row : rows)
+			{
+				row = static_cast<std::uint16_t>(random() | random());
+			}
+			DensityKernel::ShipCountsType shipCounts(1 + random() % 6);
+			for (auto& count : shipCounts)
+			{
+				count = random() % 5;
+			}
+
+			DensityKernel::CountsType expected;
+			DensityKernel::CountScalar(rows, boardSize, shipCounts, expected);
+			for (auto backend : backends)
+			{
+				if (backend == DensityKernel::Backend::eAVX2 && DensityKernel::GetBestBackend() != backend)
+				{
+					continue;
+				}
+
+				DensityKernel::CountsType actual;
+				DensityKernel::Count(rows, boardSize, shipCounts, actual, backend);
+				if (actual != expected)
+				{
+					mismatches++;
+				}
+			}
+		}
+
+		std::cout << "Ядро плотности (" << static_cast<int>(DensityKernel::GetBestBackend()) << "): "
+			<< (mismatches == 0 ? "OK" : "ОШИБКА") << ", расхождений: " << mismatches << "\n";
+		return mismatches == 0;
+	}
+
+	// Позиция середины партии на поле 10x10: часть клеток прострелена, два попадания в одном корабле
+	FleetSampler::Observation MakeSamplerObservation()
+	{
+		FleetSampler::Observation observation;
+		observation.boardSize = 10;
+		observation.allowedCells.assign(100, 1);
+		for (int row = 0; row < 4; row++)
+		{
+			for (int col = (row * 2) % 3; col < 10; col += 3)
+			{
+				observation.allowedCells[row * 10 + col] = 0;
+			}
+		}
+		observation.hitCells = { 64, 65 };
+		observation.shipLengths = GameBoard::MakeShipSizes(GameBoard::DEFAULT_SHIP_CONFIG);
+		return observation;
+	}
+
+	// Итог выборки не должен зависеть от числа потоков, а корабли - вставать на закрытые клетки
+	bool CheckFleetSampler(unsigned long long seed)
+	{
+		FleetSampler sampler(MakeSamplerObservation());
+		FleetSampler::Result single = sampler.Run(2000, 8, 1, seed);
+		FleetSampler::Result parallel = sampler.Run(2000, 8, 4, seed);
+
+		bool ok = single.samples == 16000 && single.hitCounts == parallel.hitCounts;
+		for (int cell = 0; cell < 100; cell++)
+		{
+			if (!sampler.GetObservation().allowedCells[cell] && single.hitCounts[cell] != 0)
+			{
+				ok = false;
+			}
+		}
+
+		std::cout << "Выборка флота: " << (ok ? "OK" : "ОШИБКА") << ", выборок: " << single.samples << "\n";
+		return ok;
+	}
+
+	std::string LayoutKey(const FleetGenerator::LayoutType& layout)
+	{
+		std::string key;
+		for (const auto& placement : layout)
+		{
+			key += std::to_string(placement.start.GetIndex()) + (placement.isHorizontal ? "h " : "v ");
+		}
+		return key;
+	}
+
+	// Перебор всех допустимых расстановок через GameBoard::PlaceShip
+	void EnumerateLayouts(const GameBoard& board, const GameBoard::ShipSizesType& sizes, size_t ship,
+		FleetGenerator::LayoutType& layout, std::map<std::string, long long>& counts)
+	{
+		if (ship == sizes.size())
+		{
+			counts[LayoutKey(layout)] = 0;
+			return;
+		}
+
+		for (bool horizontal : { true, false })
+		{
+			if (sizes[ship] == 1 && !horizontal)
+			{
+				continue;
+			}
+			for (int row = 0; row < board.GetSize(); row++)
+			{
+				for (int col = 0; col < board.GetSize(); col++)
+				{
+					Cell start = Cell::FromRowCol(row, col, board.GetSize());
+					if (!board.CanPlaceShip(sizes[ship], start, horizontal))
+					{
+						continue;
+					}
+
+					GameBoard next = board;
+					next.PlaceShip(sizes[ship], start, horizontal);
+					layout.push_back(FleetGenerator::Placement{ sizes[ship], start, horizontal });
+					EnumerateLayouts(next, sizes, ship + 1, layout, counts);
+					layout.pop_back();
+				}
+			}
+		}
+	}
+
+	// Частоты расстановок на малом поле сравниваются с равномерным распределением (хи-квадрат)
+	bool CheckFleetGenerator(std::mt19937& random)
+	{
+		const int boardSize = 5;
+		const GameBoard::ShipSizesType sizes = { 3, 2, 1, 1 };
+
+		std::map<std::string, long long> counts;
+		FleetGenerator::LayoutType layout;
+		EnumerateLayouts(GameBoard(boardSize), sizes, 0, layout, counts);
+
+		// Таблица чисел расстановок не различает два однопалубных корабля
+		const LayoutCountTable* table = LayoutCountTable::Get(boardSize, sizes);
+		bool ok = table && table->GetLayoutCount() * 2 == counts.size();
+
+		FleetGenerator generator(boardSize, sizes);
+		const long long perLayout = 200;
+		long long total = perLayout * static_cast<long long>(counts.size());
+		for (long long i = 0; i < total && ok; i++)
+		{
+			auto it = generator.Generate(random, layout) ? counts.find(LayoutKey(layout)) : counts.end();
+			if (it == counts.end())
+			{
+				ok = false;
+				break;
+			}
+			it->second++;
+		}
+
+		double chiSquare = 0.0;
+		for (const auto& entry : counts)
+		{
+			chiSquare += double(entry.second - perLayout) * (entry.second - perLayout) / perLayout;
+		}
+		double freedom = double(counts.size()) - 1;
+		ok = ok && chiSquare < freedom + 5.0 * std::sqrt(2.0 * freedom);
+
+		std::cout << "Генератор расстановок: " << (ok ? "OK" : "ОШИБКА") << ", расстановок: " << counts.size()
+			<< ", хи-квадрат: " << chiSquare << " (степеней свободы " << freedom << ")\n";
+		return ok;
+	}
+
+	// Выстрелы с отменой сверяются с копией поля: после каждого выстрела состояние
+	// совпадает с копией, принявшей тот же выстрел, после отмены - с исходным полем
+	bool CheckShotJournal(std::mt19937& random)
+	{
+		const int boardSizes[] = { 8, 10, 11, 16 };
+		long long shots = 0;
+		long long mismatches = 0;
+		for (int boardSize : boardSizes)
+		{
+			int cellCount = boardSize * boardSize;
+			FleetGenerator generator(boardSize, GameBoard::MakeShipSizes(GameBoard::DEFAULT_SHIP_CONFIG));
+			for (int game = 0; game < 50; game++)
+			{
+				GameBoard board(boardSize);
+				generator.PlaceFleet(board, random);
+
+				while (!board.IsAllShipsSunk())
+				{
+					// Серия пробных выстрелов, среди них повторные и за пределами поля
+					const GameBoard original = board;
+					GameBoard reference = board;
+					std::vector<GameBoard::UndoType> journal;
+					int depth = 1 + random() % 8;
+					for (int i = 0; i < depth; i++)
+					{
+						WideCell cell = random() % 16 == 0 ? WideCell() : WideCell(random() % cellCount);
+						journal.push_back(board.ApplyShot(cell));
+						if (reference.ReceiveShot(cell) != journal.back().result || !(reference == board))
+						{
+							mismatches++;
+						}
+						shots++;
+					}
+					for (auto it = journal.rbegin(); it != journal.rend(); ++it)
+					{
+						board.UndoShot(*it);
+					}
+					if (!(board == original))
+					{
+						mismatches++;
+					}
+
+					board.ReceiveShot(Cell(random() % cellCount));
+				}
+			}
+		}
+
+		std::cout << "Отмена выстрелов: " << (mismatches == 0 ? "OK" : "ОШИБКА") << ", выстрелов: " << shots
+			<< ", расхождений: " << mismatches << "\n";
+		return mismatches == 0;
+	}
+
+	// Разреженное ядро большого поля сверяется с плотным на поле, где годятся оба:
+	// одинаковые попытки расстановки, выстрелы (с повторами), отмена и виды клеток
+	bool CheckSparseBoard(std::mt19937& random)
+	{
+		const int boardSize = 40;
+		const int cellCount = boardSize * boardSize;
+		long long shots = 0;
+		long long mismatches = 0;
+		for (int trial = 0; trial < 20; trial++)
+		{
+			BoardCore<0> dense(boardSize);
+			SparseBoardCore sparse(boardSize);
+			for (int attempt = 0; attempt < 2000; attempt++)
+			{
+				int size = 1 + random() % 5;
+				int row = random() % boardSize - 1;
+				int col = random() % boardSize - 1;
+				bool horizontal = random() % 2 == 0;
+				if (dense.PlaceShip(size, row, col, horizontal) != sparse.PlaceShip(size, row, col, horizontal))
+				{
+					mismatches++;
+				}
+			}
+
+			std::vector<WideShotUndo> journal;
+			while (!dense.IsAllShipsSunk())
+			{
+				int index = random() % cellCount;
+				ShotUndo expected = dense.ApplyShot(index);
+				WideShotUndo actual = sparse.ApplyShot(index);
+				if (WideCell(expected.cell) != actual.cell || expected.result != actual.result ||
+					dense.GetAliveShipCount() != sparse.GetAliveShipCount() || dense.IsAllShipsSunk() != sparse.IsAllShipsSunk())
+				{
+					mismatches++;
+				}
+				shots++;
+
+				// Иногда отменяем несколько последних выстрелов
+				journal.push_back(actual);
+				if (random() % 8 == 0)
+				{
+					for (int undo = random() % 4; undo > 0 && !journal.empty(); undo--)
+					{
+						dense.UndoShot(ShotUndo{ Cell(journal.back().cell), journal.back().result });
+						sparse.UndoShot(journal.back());
+						journal.pop_back();
+					}
+				}
+			}
+			for (int cell = 0; cell < cellCount; cell++)
+			{
+				if (dense.GetViewCell(true, cell) != sparse.GetViewCell(true, cell) ||
+					dense.GetViewCell(false, cell) != sparse.GetViewCell(false, cell))
+				{
+					mismatches++;
+				}
+			}
+		}
+
+		// Клетки большого поля не помещаются в 16-битную Cell: выстрел и отмена идут через WideCell
+		GameBoard large(300);
+		WideCell last(300 * 300 - 1);
+		GameBoard::UndoType undo = large.ApplyShot(last);
+		if (undo.cell != last || large.GetViewCell(false, last) != SparseBoardCore::VIEW_MISS)
+		{
+			mismatches++;
+		}
+		large.UndoShot(undo);
+		if (large.GetViewCell(false, last) != SparseBoardCore::VIEW_UNKNOWN)
+		{
+			mismatches++;
+		}
+
+		// Полная партия на поле, индексы которого не помещаются в Cell: ход ИИ
+		// не должен сужаться, иначе партия упирается в предел выстрелов
+		const int hugeSize = 1000;
+		MatchEngine engine(false);
+		AIPlayer first("ИИ 1", hugeSize, random(), AIPlayer::Strategy::eRandomHunt);
+		AIPlayer second("ИИ 2", hugeSize, random(), AIPlayer::Strategy::eRandomHunt);
+		if (engine.Run(first, second).winner == MatchResult::NO_WINNER)
+		{
+			mismatches++;
+		}
+
+		// Флот растет с площадью без скачков: не быстрее площади с точностью до одного стандартного флота
+		long long standard = static_cast<long long>(GameBoard::MakeFleetSizes(GameBoard::DEFAULT_BOARD_SIZE).size());
+		for (int size = 2; size < 4 * GameBoard::MAX_DENSE_BOARD_SIZE; size++)
+		{
+			long long count = static_cast<long long>(GameBoard::MakeFleetSizes(size).size());
+			long long next = static_cast<long long>(GameBoard::MakeFleetSizes(size + 1).size());
+			if (next < count || next * size * size > (count + standard) * (size + 1) * (size + 1))
+			{
+				mismatches++;
+			}
+		}
+
+		std::cout << "Разреженное поле: " << (mismatches == 0 ? "OK" : "ОШИБКА") << ", выстрелов: " << shots
+			<< ", расхождений: " << mismatches << "\n";
+		return mismatches == 0;
+	}
+
+	// Поле, восстановленное из снимка, совпадает с исходным; снимок копируется побайтно
+	template <int N>
+	long long CheckSnapshots(std::mt19937& random, long long& snapshots)
+	{
+		FleetGenerator generator(N, GameBoard::MakeShipSizes(GameBoard::DEFAULT_SHIP_CONFIG));
+		long long mismatches = 0;
+		for (int game = 0; game < 50; game++)
+		{
+			GameBoard board(N);
+			generator.PlaceFleet(board, random);
+			while (!board.IsAllShipsSunk())
+			{
+				BoardSnapshot<N> snapshot;
+				BoardSnapshot<N> copy;
+				if (!board.TakeSnapshot(snapshot))
+				{
+					return mismatches + 1;
+				}
+				std::memcpy(&copy, &snapshot, sizeof(copy));
+				if (!(GameBoard(copy) == board))
+				{
+					mismatches++;
+				}
+				snapshots++;
+				board.ReceiveShot(Cell(random() % (N * N)));
+			}
+		}
+		return mismatches;
+	}
+
+	bool CheckBoardSnapshot(std::mt19937& random)
+	{
+		long long snapshots = 0;
+		long long mismatches = CheckSnapshots<8>(random, snapshots) + CheckSnapshots<10>(random, snapshots)
+			+ CheckSnapshots<12>(random, snapshots) + CheckSnapshots<16>(random, snapshots);
+
+		std::cout << "Снимки поля: " << (mismatches == 0 ? "OK" : "ОШИБКА") << ", снимков: " << snapshots
+			<< ", расхождений: " << mismatches << " (" << sizeof(BoardSnapshot<10>) << " байт для 10x10)\n";
+		return mismatches == 0;
+	}
+
+	// Ядро поля набора правил принимает ровно те позиции, что и перебор
+	// окрестностей по правилу касания, и попадания приходятся на корабли.
+	// Генератор с правилом касания набора ставит на это ядро весь флот
+	template <class Rules>
+	long long CheckRuleSet(std::mt19937& random, long long& ships)
+	{
+		using Traits = RuleTraits<Rules>;
+		const int boardSize = Traits::BOARD_SIZE;
+		long long mismatches = 0;
+		for (int trial = 0; trial < 200; trial++)
+		{
+			typename Traits::CoreType core;
+			std::vector<int> owners(boardSize * boardSize, Traits::CoreType::NO_SHIP);
+			int shipCount = 0;
+			for (int attempt = 0; attempt < 300; attempt++)
+			{
+				int size = Traits::SHIP_SIZES[attempt % Traits::SHIP_COUNT];
+				int row = random() % boardSize;
+				int col = random() % boardSize;
+				bool horizontal = random() % 2 == 0;
+				int endRow = horizontal ? row : row + size - 1;
+				int endCol = horizontal ? col + size - 1 : col;
+
+				bool expected = endRow < boardSize && endCol < boardSize && shipCount < Traits::CoreType::MAX_SHIPS;
+				for (int r = std::max(row - 1, 0); expected && r <= std::min(endRow + 1, boardSize - 1); r++)
+				{
+					for (int c = std::max(col - 1, 0); c <= std::min(endCol + 1, boardSize - 1); c++)
+					{
+						if (owners[r * boardSize + c] != Traits::CoreType::NO_SHIP &&
+							PlacementTables::IsInHalo(Traits::ADJACENCY, r, c, row, col, endRow, endCol))
+						{
+							expected = false;
+						}
+					}
+				}
+
+				if (core.PlaceShip(size, row, col, horizontal) != expected)
+				{
+					mismatches++;
+				}
+				else if (expected)
+				{
+					for (int i = 0; i < size; i++)
+					{
+						owners[(row + (horizontal ? 0 : i)) * boardSize + col + (horizontal ? i : 0)] = shipCount;
+					}
+					shipCount++;
+				}
+			}
+			ships += shipCount;
+
+			for (int cell = 0; cell < boardSize * boardSize; cell++)
+			{
+				Ship::ShotResult result = core.ReceiveShot(cell);
+				if ((result == Ship::ShotResult::eMiss) != (owners[cell] == Traits::CoreType::NO_SHIP))
+				{
+					mismatches++;
+				}
+			}
+			if (!core.IsAllShipsSunk() || core.GetAliveShipCount() != 0 || core.GetShipCount() != shipCount)
+			{
+				mismatches++;
+			}
+		}
+
+		FleetGenerator generator(boardSize, GameBoard::MakeShipSizes(Rules::SHIP_CONFIG), Traits::ADJACENCY);
+		for (int trial = 0; trial < 200; trial++)
+		{
+			typename Traits::CoreType core;
+			if (!generator.PlaceFleet(core, random) || core.GetShipCount() != Traits::SHIP_COUNT)
+			{
+				mismatches++;
+			}
+			ships += core.GetShipCount();
+		}
+		return mismatches;
+	}
+
+	bool CheckRuleSets(std::mt19937& random)
+	{
+		long long ships = 0;
+		long long mismatches = CheckRuleSet<RussianRules>(random, ships) + CheckRuleSet<HasbroRules>(random, ships)
+			+ CheckRuleSet<DiagonalRules>(random, ships);
+
+		// Партии по каждому набору правил доигрываются: ИИ не объявляет пустой
+		// клетку корабля, отмечая окрестность потопленного по правилу касания
+		MatchEngine engine(false);
+		for (const RuleChoice& rules : { RuleChoice::Make<RussianRules>(), RuleChoice::Make<HasbroRules>(), RuleChoice::Make<DiagonalRules>() })
+		{
+			for (int game = 0; game < 100; game++)
+			{
+				AIPlayer first("ИИ 1", rules, random());
+				AIPlayer second("ИИ 2", rules, random());
+				if (engine.Run(first, second).winner == MatchResult::NO_WINNER ||
+					first.GetMyBoard().GetAdjacency() != rules.adjacency)
+				{
+					mismatches++;
+				}
+			}
+		}
+
+		std::cout << "Наборы правил: " << (mismatches == 0 ? "OK" : "ОШИБКА") << ", кораблей: " << ships
+			<< ", расхождений: " << mismatches << "\n";
+		return mismatches == 0;
+	}
+
+	// Пакетная проверка расстановок совпадает с расстановкой кораблей по одному
+	// на ядро поля набора правил. Расстановки берутся из генератора, и в части
+	// из них один корабль переставлен или изменен случайно.
+	template <class Rules>
+	long long CheckLayoutValidatorRules(std::mt19937& random, long long& invalid)
+	{
+		using Traits = RuleTraits<Rules>;
+		const int boardSize = Traits::BOARD_SIZE;
+		GameBoard::ShipSizesType shipSizes = GameBoard::MakeShipSizes(Rules::SHIP_CONFIG);
+		LayoutValidator validator(boardSize, shipSizes, Traits::ADJACENCY);
+		FleetGenerator generator(boardSize, shipSizes, Traits::ADJACENCY);
+		FleetGenerator::LayoutType layout;
+		LayoutValidator::RecordsType records;
+		for (int i = 0; i < 2000; i++)
+		{
+			generator.Generate(random, layout);
+			LayoutValidator::EncodeLayout(layout, records);
+			std::uint8_t* record = records.data() + i * validator.GetRecordSize();
+			int ship = random() % validator.GetShipCount() * LayoutValidator::BYTES_PER_SHIP;
+			switch (random() % 4)
+			{
+			case 0:
+				record[ship] = static_cast<std::uint8_t>(random() % 256);
+				break;
+			case 1:
+				record[ship + 1] = static_cast<std::uint8_t>(random() % 256);
+				break;
+			case 2:
+				record[ship] = static_cast<std::uint8_t>(random() % (boardSize * boardSize));
+				record[ship + 1] ^= LayoutValidator::HORIZONTAL_FLAG;
+				break;
+			default:
+				break;
+			}
+		}
+
+		LayoutValidator::ReasonsType reasons(records.size() / validator.GetRecordSize());
+		validator.ValidateBatch(records, reasons, 2);
+
+		long long mismatches = 0;
+		for (size_t i = 0; i < reasons.size(); i++)
+		{
+			const std::uint8_t* record = records.data() + i * validator.GetRecordSize();
+			typename Traits::CoreType core;
+			GameBoard::ShipSizesType lengths;
+			bool expected = true;
+			for (int ship = 0; ship < validator.GetShipCount() && expected; ship++)
+			{
+				int start = record[ship * LayoutValidator::BYTES_PER_SHIP];
+				int shape = record[ship * LayoutValidator::BYTES_PER_SHIP + 1];
+				int length = shape & LayoutValidator::LENGTH_MASK;
+				expected = length <= boardSize &&
+					core.PlaceShip(length, start / boardSize, start % boardSize, (shape & LayoutValidator::HORIZONTAL_FLAG) != 0);
+				lengths.push_back(length);
+			}
+			std::sort(lengths.begin(), lengths.end());
+			GameBoard::ShipSizesType fleet = shipSizes;
+			std::sort(fleet.begin(), fleet.end());
+			expected = expected && lengths == fleet;
+
+			if (expected != (reasons[i] == LayoutValidator::Reason::eValid))
+			{
+				mismatches++;
+			}
+			invalid += expected ? 0 : 1;
+		}
+		return mismatches;
+	}
+
+	bool CheckLayoutValidator(std::mt19937& random)
+	{
+		long long invalid = 0;
+		long long mismatches = CheckLayoutValidatorRules<RussianRules>(random, invalid)
+			+ CheckLayoutValidatorRules<HasbroRules>(random, invalid) + CheckLayoutValidatorRules<DiagonalRules>(random, invalid);
+
+		std::cout << "Проверка расстановок: " << (mismatches == 0 ? "OK" : "ОШИБКА") << ", недопустимых: " << invalid
+			<< ", расхождений: " << mismatches << "\n";
+		return mismatches == 0;
+	}
+
+	// Эталон для FleetSolver: корабли ставятся по очереди, следующий корабль
+	// той же длины - только дальше предыдущего, чтобы не считать перестановки
+	std::uint64_t CountLayoutsBruteForce(int boardSize, const GameBoard::ShipSizesType& sizes, PlacementTables::Adjacency adjacency,
+		size_t ship, int firstStart, std::vector<bool>& occupied)
+	{
+		if (ship == sizes.size())
+		{
+			return 1;
+		}
+
+		std::uint64_t total = 0;
+		int length = sizes[ship];
+		for (int start = firstStart; start < boardSize * boardSize; start++)
+		{
+			for (bool horizontal : { true, false })
+			{
+				int row = start / boardSize;
+				int col = start % boardSize;
+				int endRow = horizontal ? row : row + length - 1;
+				int endCol = horizontal ? col + length - 1 : col;
+				if ((!horizontal && length == 1) || endRow >= boardSize || endCol >= boardSize)
+				{
+					continue;
+				}
+
+				bool fits = true;
+				for (int r = std::max(row - 1, 0); r <= std::min(endRow + 1, boardSize - 1) && fits; r++)
+				{
+					for (int c = std::max(col - 1, 0); c <= std::min(endCol + 1, boardSize - 1) && fits; c++)
+					{
+						fits = !(occupied[r * boardSize + c] && PlacementTables::IsInHalo(adjacency, r, c, row, col, endRow, endCol));
+					}
+				}
+				if (!fits)
+				{
+					continue;
+				}
+
+				for (int k = 0; k < length; k++)
+				{
+					occupied[horizontal ? start + k : start + k * boardSize] = true;
+				}
+				bool sameNext = ship + 1 < sizes.size() && sizes[ship + 1] == length;
+				total += CountLayoutsBruteForce(boardSize, sizes, adjacency, ship + 1, sameNext ? start + 1 : 0, occupied);
+				for (int k = 0; k < length; k++)
+				{
+					occupied[horizontal ? start + k : start + k * boardSize] = false;
+				}
+			}
+		}
+		return total;
+	}
+
+	// Сверка числа расстановок FleetSolver с полным перебором на маленьких полях
+	bool CheckFleetSolver(std::mt19937& random)
+	{
+		const PlacementTables::Adjacency adjacencies[] = {
+			PlacementTables::Adjacency::eNoTouch, PlacementTables::Adjacency::eDiagonal, PlacementTables::Adjacency::eTouch
+		};
+
+		long long cases = 0;
+		long long infeasible = 0;
+		long long mismatches = 0;
+		for (int iteration = 0; iteration < 60; iteration++)
+		{
+			int boardSize = 3 + static_cast<int>(random() % 4);
+			int shipCount = 1 + static_cast<int>(random() % 4);
+			GameBoard::ShipSizesType sizes;
+			for (int ship = 0; ship < shipCount; ship++)
+			{
+				sizes.push_back(1 + static_cast<int>(random() % std::min(boardSize, 4)));
+			}
+			std::sort(sizes.begin(), sizes.end(), std::greater<int>());
+			PlacementTables::Adjacency adjacency = adjacencies[iteration % 3];
+
+			std::vector<bool> occupied(boardSize * boardSize, false);
+			std::uint64_t expected = CountLayoutsBruteForce(boardSize, sizes, adjacency, 0, 0, occupied);
+			FleetSolver solver(boardSize, sizes, adjacency);
+			FleetSolver::Result counted = solver.Solve(true);
+			FleetSolver::Result decided = solver.Solve(false);
+			FleetSolver::Feasibility feasibility = expected > 0 ? FleetSolver::Feasibility::eFeasible : FleetSolver::Feasibility::eInfeasible;
+			if (!counted.counted || counted.layoutCount != expected || counted.feasibility != feasibility ||
+				decided.feasibility != feasibility)
+			{
+				mismatches++;
+			}
+			infeasible += expected == 0;
+			cases++;
+		}
+
+		// Полный флот не помещается на поле 6x6, но помещается на 7x7
+		GameBoard::ShipSizesType fleet = GameBoard::MakeShipSizes(GameBoard::DEFAULT_SHIP_CONFIG);
+		mismatches += FleetSolver(6, fleet).Solve(false).feasibility != FleetSolver::Feasibility::eInfeasible;
+		mismatches += FleetSolver(7, fleet).Solve(false).feasibility != FleetSolver::Feasibility::eFeasible;
+
+		std::cout << "Решатель флота: " << (mismatches == 0 ? "OK" : "ОШИБКА") << ", случаев " << cases
+			<< ", невозможных " << infeasible << ", расхождений " << mismatches << "\n";
+		return mismatches == 0;
+	}
+
+	// Выводы KnowledgeBoard на случайных расстановках: пустой не объявляется
+	// ни одна клетка корабля, направление совпадает с настоящим, а после
+	// потопления всего флота пусты все остальные клетки
+	bool CheckKnowledgeBoard(std::mt19937& random)
+	{
+		const int sizes[] = { 7, 10, 12, 16 };
+		long long inferredCount = 0;
+		long long mismatches = 0;
+		for (int game = 0; game < 400; game++)
+		{
+			int boardSize = sizes[game % 4];
+			int cellCount = boardSize * boardSize;
+			GameBoard::ShipSizesType shipSizes = GameBoard::MakeShipSizes(GameBoard::DEFAULT_SHIP_CONFIG);
+			FleetGenerator generator(boardSize, shipSizes);
+			FleetGenerator::LayoutType layout;
+			if (!generator.Generate(random, layout))
+			{
+				continue;
+			}
+
+			// Корабль каждой клетки (-1 - вода) и попадания по кораблям
+			std::vector<int> shipOf(cellCount, -1);
+			std::vector<KnowledgeBoard::CellsType> shipCells(layout.size());
+			KnowledgeBoard::ShipCountsType shipCounts;
+			for (size_t ship = 0; ship < layout.size(); ship++)
+			{
+				const FleetGenerator::Placement& placement = layout[ship];
+				for (int k = 0; k < placement.size; k++)
+				{
+					int cell = placement.start.GetIndex() + (placement.isHorizontal ? k : k * boardSize);
+					shipOf[cell] = static_cast<int>(ship);
+					shipCells[ship].push_back(cell);
+				}
+				if (placement.size >= static_cast<int>(shipCounts.size()))
+				{
+					shipCounts.resize(placement.size + 1, 0);
+				}
+				shipCounts[placement.size]++;
+			}
+
+			KnowledgeBoard knowledge(boardSize, shipCounts);
+			KnowledgeBoard::CellsType inferred;
+			std::vector<int> hits(layout.size(), 0);
+			std::vector<int> order(cellCount);
+			std::iota(order.begin(), order.end(), 0);
+			std::shuffle(order.begin(), order.end(), random);
+			auto verify = [&]()
+			{
+				for (int empty : inferred)
+				{
+					mismatches += shipOf[empty] >= 0;
+				}
+				inferredCount += inferred.size();
+			};
+			for (int cell : order)
+			{
+				// Как ИИ, в клетки, где корабля быть не может, не стреляем
+				if (!knowledge.IsUnknown(cell))
+				{
+					continue;
+				}
+
+				int ship = shipOf[cell];
+				if (ship < 0)
+				{
+					knowledge.MarkMiss(cell, inferred);
+					verify();
+				}
+				else
+				{
+					knowledge.MarkHit(cell, inferred);
+					verify();
+					KnowledgeBoard::Axis axis = knowledge.GetAxis(cell);
+					KnowledgeBoard::Axis expected = layout[ship].isHorizontal ? KnowledgeBoard::Axis::eHorizontal : KnowledgeBoard::Axis::eVertical;
+					mismatches += axis != KnowledgeBoard::Axis::eUnknown && axis != expected;
+					if (++hits[ship] == layout[ship].size)
+					{
+						knowledge.MarkSunk(shipCells[ship], inferred);
+						verify();
+					}
+				}
+			}
+
+			for (int cell = 0; cell < cellCount; cell++)
+			{
+				mismatches += knowledge.IsShip(cell) != (shipOf[cell] >= 0) || knowledge.IsUnknown(cell);
+			}
+		}
+
+		std::cout << "Знания о поле: " << (mismatches == 0 ? "OK" : "ОШИБКА") << ", выведено пустых: " << inferredCount
+			<< ", расхождений: " << mismatches << "\n";
+		return mismatches == 0;
+	}
+
+	// Помещается ли флот поля и сколькими способами (результат - из кэша или решателя)
+	void RunFleetInfo(int boardSize, const std::string& cachePath)
+	{
+		FleetSolver solver(boardSize, GameBoard::MakeFleetSizes(boardSize));
+		auto start = std::chrono::steady_clock::now();
+		FleetSolver::Result result = solver.SolveCached(true, cachePath);
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		const char* feasibility = result.feasibility == FleetSolver::Feasibility::eFeasible ? "помещается"
+			: result.feasibility == FleetSolver::Feasibility::eInfeasible ? "не помещается" : "неизвестно";
+		std::cout << "Флот " << solver.MakeCacheKey() << ": " << feasibility << "\n";
+		if (result.counted)
+		{
+			std::cout << "Расстановок: " << (result.saturated ? "больше " : "") << result.layoutCount
+				<< ", состояний перебора " << result.states << "\n";
+		}
+		else
+		{
+			std::cout << "Расстановки не посчитаны: поле слишком велико для полного перебора\n";
+		}
+		std::cout << "Время: " << seconds << " с\n";
+	}
+
+	bool RunSelfCheck(unsigned long long seed)
+	{
+		std::mt19937 random(static_cast<std::uint32_t>(seed));
+		bool ok = true;
+		ok = CheckDensityKernel(random, 100000) && ok;
+		ok = CheckFleetSampler(seed) && ok;
+		ok = CheckFleetGenerator(random) && ok;
+		ok = CheckShotJournal(random) && ok;
+		ok = CheckBoardSnapshot(random) && ok;
+		ok = CheckSparseBoard(random) && ok;
+		ok = CheckRuleSets(random) && ok;
+		ok = CheckLayoutValidator(random) && ok;
+		ok = CheckFleetSolver(random) && ok;
+		ok = CheckKnowledgeBoard(random) && ok;
+		return ok;
+	}
+
+	void RunLayoutBenchmark(unsigned long long seed, int boardSize)
+	{
+		std::mt19937 random(static_cast<std::uint32_t>(seed));
+		const GameBoard::ShipSizesType shipSizes = GameBoard::MakeShipSizes(GameBoard::DEFAULT_SHIP_CONFIG);
+
+		// Первый генератор поля строит таблицу чисел расстановок, если она помещается
+		auto buildStart = std::chrono::steady_clock::now();
+		FleetGenerator generator(boardSize, shipSizes);
+		double buildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - buildStart).count();
+		FleetGenerator::LayoutType layout;
+		if (generator.IsCounted())
+		{
+			const LayoutCountTable* counts = LayoutCountTable::Get(boardSize, shipSizes);
+			std::cout << "Таблица чисел расстановок: узлов " << counts->GetNodeCount() << ", чисел " << counts->GetEntryCount()
+				<< ", расстановок " << counts->GetLayoutCount() << ", построена за " << buildSeconds << " с\n";
+		}
+		else
+		{
+			std::cout << "Таблица чисел расстановок не строится: расстановки подбираются попытками\n";
+		}
+
+		const long long layouts = 20000;
+		long long attempts = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (long long i = 0; i < layouts; i++)
+		{
+			generator.Generate(random, layout);
+			attempts += generator.GetAttempts();
+		}
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		std::cout << "Расстановок: " << layouts << " (поле " << boardSize << "x" << boardSize << ")\n";
+		std::cout << "Попыток на расстановку: " << double(attempts) / layouts << "\n";
+		std::cout << "Расстановок в секунду: " << (seconds > 0 ? layouts / seconds : 0.0) << "\n";
+	}
+
+	// Залпы по случайным полям: k выстрелов одним ReceiveShots или k вызовами ReceiveShot,
+	// k - число непотопленных кораблей поля
+	void RunSalvoBenchmark(unsigned long long seed, int boardSize)
+	{
+		std::mt19937 random(static_cast<std::uint32_t>(seed));
+		FleetGenerator generator(boardSize, GameBoard::MakeShipSizes(GameBoard::DEFAULT_SHIP_CONFIG));
+
+		const int boardCount = 1000;
+		const int rounds = 20;
+		std::vector<GameBoard> boards;
+		std::vector<std::vector<Cell>> orders(boardCount);
+		for (int i = 0; i < boardCount; i++)
+		{
+			boards.emplace_back(boardSize);
+			generator.PlaceFleet(boards.back(), random);
+			for (int cell = 0; cell < boardSize * boardSize; cell++)
+			{
+				orders[i].push_back(Cell(cell));
+			}
+			std::shuffle(orders[i].begin(), orders[i].end(), random);
+		}
+
+		std::vector<Ship::ShotResult> results(boardSize * boardSize);
+		auto play = [&](bool batched, long long& shots, long long& checksum)
+		{
+			auto start = std::chrono::steady_clock::now();
+			for (int round = 0; round < rounds; round++)
+			{
+				for (int i = 0; i < boardCount; i++)
+				{
+					GameBoard board = boards[i];
+					size_t next = 0;
+					while (!board.IsAllShipsSunk() && next < orders[i].size())
+					{
+						size_t count = std::min<size_t>(board.GetAliveShipCount(), orders[i].size() - next);
+						std::span<const Cell> salvo(orders[i].data() + next, count);
+						if (batched)
+						{
+							board.ReceiveShots(salvo, results);
+						}
+						else
+						{
+							for (size_t shot = 0; shot < count; shot++)
+							{
+								results[shot] = board.ReceiveShot(salvo[shot]);
+							}
+						}
+						for (size_t shot = 0; shot < count; shot++)
+						{
+							checksum += static_cast<int>(results[shot]);
+						}
+						shots += count;
+						next += count;
+					}
+				}
+			}
+			return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		};
+
+		long long singleShots = 0;
+		long long singleChecksum = 0;
+		long long batchedShots = 0;
+		long long batchedChecksum = 0;
+		double singleSeconds = play(false, singleShots, singleChecksum);
+		double batchedSeconds = play(true, batchedShots, batchedChecksum);
+
+		std::cout << "Залпы: " << boardCount * rounds << " партий (поле " << boardSize << "x" << boardSize << "), "
+			<< batchedShots << " выстрелов" << (singleChecksum == batchedChecksum ? "" : " - РЕЗУЛЬТАТЫ РАЗЛИЧАЮТСЯ") << "\n";
+		std::cout << "ReceiveShot по одному: " << (singleSeconds > 0 ? singleShots / singleSeconds : 0.0) << " выстрелов/с\n";
+		std::cout << "ReceiveShots залпом: " << (batchedSeconds > 0 ? batchedShots / batchedSeconds : 0.0) << " выстрелов/с\n";
+	}
+
+	// Начало партии: два ИИ создаются и расставляют флот. Пулу сначала дается
+	// заполнить буфер, затем серия партий начинается подряд - так, как игры
+	// приходят на сервер пачками
+	void RunPoolBenchmark(unsigned long long seed, int boardSize, int threads)
+	{
+		if (threads <= 0)
+		{
+			threads = std::max(1u, std::thread::hardware_concurrency() - 1);
+		}
+
+		const long long setups = 2000;
+		auto run = [&](LayoutPool* pool)
+		{
+			auto start = std::chrono::steady_clock::now();
+			for (long long game = 0; game < setups; game++)
+			{
+				AIPlayer first("ИИ 1", boardSize, static_cast<std::uint32_t>(seed + game * 2), AIPlayer::Strategy::eRandomHunt);
+				AIPlayer second("ИИ 2", boardSize, static_cast<std::uint32_t>(seed + game * 2 + 1), AIPlayer::Strategy::eRandomHunt);
+				first.SetLayoutPool(pool);
+				second.SetLayoutPool(pool);
+				first.PlaceShips();
+				second.PlaceShips();
+			}
+			return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		};
+
+		double directSeconds = run(nullptr);
+
+		LayoutPool pool(threads, static_cast<int>(setups * 2));
+		pool.AddFleet(boardSize, GameBoard::MakeFleetSizes(boardSize));
+		pool.Start();
+		while (pool.GetProduced() < setups * 2)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		double pooledSeconds = run(&pool);
+		pool.Stop();
+
+		std::cout << "Начало партии: " << setups << " партий (поле " << boardSize << "x" << boardSize
+			<< "), потоков пула " << pool.GetThreadCount() << "\n";
+		std::cout << "Без пула: " << (directSeconds > 0 ? setups / directSeconds : 0.0) << " партий/с, "
+			<< directSeconds / setups * 1e6 << " мкс на партию\n";
+		std::cout << "С пулом: " << (pooledSeconds > 0 ? setups / pooledSeconds : 0.0) << " партий/с, "
+			<< pooledSeconds / setups * 1e6 << " мкс на партию"
+			<< ", из пула " << pool.GetPopped() << ", синхронно " << pool.GetFallbacks() << "\n";
+	}
+
+	void RunSamplerBenchmark(unsigned long long seed, int threads)
+	{
+		if (threads <= 0)
+		{
+			threads = std::max(1u, std::thread::hardware_concurrency());
+		}
+
+		FleetSampler sampler(MakeSamplerObservation());
+		FleetSampler::Result result = sampler.Run(20000, threads * 4, threads, seed);
+
+		std::cout << "Выборка флота: цепей " << threads * 4 << ", потоков " << threads
+			<< ", выборок " << result.samples << "\n";
+		std::cout << "Время: " << result.seconds << " с\n";
+		std::cout << "Выборок в секунду: " << result.GetSamplesPerSecond() << "\n";
+
+		// Вероятности соседей попаданий - по ним ИИ выбирает следующий выстрел
+		const int cells[] = { 54, 55, 63, 66, 74, 75 };
+		for (int cell : cells)
+		{
+			std::cout << "  клетка (" << cell / 10 << ", " << cell % 10 << "): "
+				<< double(result.hitCounts[cell]) / std::max(1LL, result.samples) << "\n";
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	long long games = 100000;
+	int boardSize = GameBoard::DEFAULT_BOARD_SIZE;
+	unsigned long long seed = 1;
+	int threads = 0;
+	std::string outPath;
+	AIPlayer::Strategy strategies[2] = { AIPlayer::Strategy::eRandomHunt, AIPlayer::Strategy::eRandomHunt };
+	AIPlayer::SamplerSettings samplerSettings;
+	std::string rulesName;
+	RuleChoice rules{};
+	bool selfCheck = false;
+	bool samplerBenchmark = false;
+	bool layoutBenchmark = false;
+	bool salvoBenchmark = false;
+	bool poolBenchmark = false;
+	bool usePool = false;
+	bool fleetInfo = false;
+	std::string fleetCachePath;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg == "--games" && i + 1 < argc)
+		{
+			games = std::atoll(argv[++i]);
+		}
+		else if (arg == "--size" && i + 1 < argc)
+		{
+			boardSize = std::atoi(argv[++i]);
+		}
+		else if (arg == "--seed" && i + 1 < argc)
+		{
+			seed = std::strtoull(argv[++i], nullptr, 10);
+		}
+		else if (arg == "--threads" && i + 1 < argc)
+		{
+			threads = std::atoi(argv[++i]);
+		}
+		else if (arg == "--out" && i + 1 < argc)
+		{
+			outPath = argv[++i];
+		}
+		else if ((arg == "--ai1" || arg == "--ai2") && i + 1 < argc)
+		{
+			if (!ParseStrategy(argv[++i], strategies[arg == "--ai1" ? 0 : 1]))
+			{
+				std::cerr << "Неизвестная стратегия: " << argv[i] << "\n";
+				return 1;
+			}
+		}
+		else if (arg == "--rules" && i + 1 < argc)
+		{
+			rulesName = argv[++i];
+			if (!RuleChoice::Parse(rulesName, rules))
+			{
+				std::cerr << "Неизвестные правила: " << rulesName << "\n";
+				return 1;
+			}
+		}
+		else if (arg == "--mcmc-samples" && i + 1 < argc)
+		{
+			samplerSettings.samples = std::atoi(argv[++i]);
+		}
+		else if (arg == "--mcmc-chains" && i + 1 < argc)
+		{
+			samplerSettings.chains = std::atoi(argv[++i]);
+		}
+		else if (arg == "--mcmc-threads" && i + 1 < argc)
+		{
+			samplerSettings.threads = std::atoi(argv[++i]);
+		}
+		else if (arg == "--pool")
+		{
+			usePool = true;
+		}
+		else if (arg == "--selfcheck")
+		{
+			selfCheck = true;
+		}
+		else if (arg == "--sampler-bench")
+		{
+			samplerBenchmark = true;
+		}
+		else if (arg == "--layout-bench")
+		{
+			layoutBenchmark = true;
+		}
+		else if (arg == "--salvo-bench")
+		{
+			salvoBenchmark = true;
+		}
+		else if (arg == "--pool-bench")
+		{
+			poolBenchmark = true;
+		}
+		else if (arg == "--fleet-info")
+		{
+			fleetInfo = true;
+		}
+		else if (arg == "--fleet-cache" && i + 1 < argc)
+		{
+			fleetCachePath = argv[++i];
+		}
+		else
+		{
+			std::cerr << "Неизвестный параметр: " << arg << "\n";
+			std::cerr << "Использование: battleship_sim [--games N] [--size N] [--seed S] [--threads T] [--out FILE]"
+				<< " [--ai1 random|density|mcmc] [--ai2 random|density|mcmc] [--rules russian|hasbro|diagonal] [--mcmc-samples N] [--mcmc-chains C] [--mcmc-threads T] [--pool] [--selfcheck] [--sampler-bench] [--layout-bench] [--salvo-bench] [--pool-bench]"
+				<< " [--fleet-info] [--fleet-cache FILE]\n";
+			return 1;
+		}
+	}
+
+	if (selfCheck)
+	{
+		return RunSelfCheck(seed) ? 0 : 1;
+	}
+
+	if (samplerBenchmark)
+	{
+		RunSamplerBenchmark(seed, threads);
+		return 0;
+	}
+
+	if (layoutBenchmark)
+	{
+		RunLayoutBenchmark(seed, boardSize);
+		return 0;
+	}
+
+	if (salvoBenchmark)
+	{
+		RunSalvoBenchmark(seed, boardSize);
+		return 0;
+	}
+
+	if (poolBenchmark)
+	{
+		RunPoolBenchmark(seed, boardSize, threads);
+		return 0;
+	}
+
+	if (rulesName.empty())
+	{
+		rules = GameBoard::MakeRules(boardSize);
+	}
+	boardSize = rules.boardSize;
+
+	if (games <= 0 || boardSize <= 0)
+	{
+		std::cerr << "Число партий и размер поля должны быть положительными\n";
+		return 1;
+	}
+	if (samplerSettings.samples <= 0 || samplerSettings.chains <= 0 || samplerSettings.threads <= 0)
+	{
+		std::cerr << "Число выборок, цепей и потоков mcmc должно быть положительным\n";
+		return 1;
+	}
+	if (boardSize > GameBoard::MAX_BOARD_SIZE)
+	{
+		std::cerr << "Размер поля не больше " << GameBoard::MAX_BOARD_SIZE << "\n";
+		return 1;
+	}
+
+	if (fleetInfo)
+	{
+		RunFleetInfo(boardSize, fleetCachePath.empty() ? FleetSolver::DEFAULT_CACHE_PATH : fleetCachePath);
+		return 0;
+	}
+
+	for (AIPlayer::Strategy strategy : strategies)
+	{
+		if (!AIPlayer::IsStrategySupported(strategy, boardSize, rules.adjacency))
+		{
+			std::cerr << "Стратегии density и mcmc доступны только на полях до " << GameBoard::MAX_DENSE_BOARD_SIZE
+				<< "x" << GameBoard::MAX_DENSE_BOARD_SIZE << " и без касаний кораблей, иначе - только random\n";
+			return 1;
+		}
+	}
+
+	// Флот, который не помещается на поле, расставлялся бы бесконечно. Без
+	// --fleet-cache проверка не оставляет файлов: возможность расстановки
+	// почти всегда решает укладка рядами без перебора
+	FleetSolver fleetSolver(boardSize, rules.shipSizes, rules.adjacency);
+	FleetSolver::Result fleetCheck = fleetCachePath.empty() ? fleetSolver.Solve(false) : fleetSolver.SolveCached(false, fleetCachePath);
+	if (fleetCheck.feasibility == FleetSolver::Feasibility::eInfeasible)
+	{
+		std::cerr << "Флот не помещается на поле " << boardSize << "x" << boardSize << "\n";
+		return 1;
+	}
+
+	Tournament tournament(boardSize, seed, threads, strategies[0], strategies[1]);
+	tournament.SetSamplerSettings(samplerSettings);
+	tournament.SetRules(rules);
+	LayoutPool layoutPool;
+	if (usePool)
+	{
+		layoutPool.AddFleet(boardSize, GameBoard::MakeFleetSizes(boardSize));
+		layoutPool.Start();
+		tournament.SetLayoutPool(&layoutPool);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	tournament.Run(games);
+	auto finish = std::chrono::steady_clock::now();
+	double seconds = std::chrono::duration<double>(finish - start).count();
+
+	std::cout << "Партий: " << games << " (поле " << boardSize << "x" << boardSize
+		<< ", зерно " << seed << ", потоков " << tournament.GetThreadCount() << ")\n";
+	std::cout << "Побед ИИ 1: " << tournament.GetWins(0) << ", побед ИИ 2: " << tournament.GetWins(1)
+		<< ", не завершено: " << tournament.GetUnfinished() << "\n";
+	std::cout << "Выстрелов за партию в среднем: " << double(tournament.GetTotalShots()) / games << "\n";
+	std::cout << "Время: " << seconds << " с\n";
+	std::cout << "Партий в секунду: " << (seconds > 0 ? games / seconds : 0.0) << "\n";
+	std::cout << "Выстрелов в секунду: " << (seconds > 0 ? tournament.GetTotalShots() / seconds : 0.0) << "\n";
+	if (usePool)
+	{
+		layoutPool.Stop();
+		std::cout << "Расстановок из пула: " << layoutPool.GetPopped() << ", синхронно: " << layoutPool.GetFallbacks()
+			<< ", флот не заказан в пуле: " << layoutPool.GetUnordered() << "\n";
+	}
+
+	if (!outPath.empty() && !tournament.WriteResults(outPath))
+	{
+		std::cerr << "Не удалось записать файл результатов: " << outPath << "\n";
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,198 @@
+﻿#include "SparseBoardCore.hpp"
+#include <algorithm>
+
+SparseBoardCore::SparseBoardCore(int size)
+	: m_size(size)
+	, m_tilesPerRow((size + TILE_SIZE - 1) / TILE_SIZE)
+	, m_maxShipSize(0)
+	, m_aliveShipCount(0)
+	, m_remainingShipCells(0)
+{
+}
+
+bool SparseBoardCore::CanPlaceShip(int size, int row, int col, bool isHorizontal) const
+{
+	int endRow = isHorizontal ? row : row + size - 1;
+	int endCol = isHorizontal ? col + size - 1 : col;
+	if (size <= 0 || size > Ship::MAX_SIZE || row < 0 || col < 0 || endRow >= m_size || endCol >= m_size)
+	{
+		return false;
+	}
+
+	// Корабль вместе с окрестностью не должен задевать занятые клетки.
+	// Прямоугольник проверяется по плиткам, отсутствующая плитка пуста
+	int top = std::max(row - 1, 0);
+	int bottom = std::min(endRow + 1, m_size - 1);
+	int left = std::max(col - 1, 0);
+	int right = std::min(endCol + 1, m_size - 1);
+	for (int tileRow = top / TILE_SIZE; tileRow <= bottom / TILE_SIZE; tileRow++)
+	{
+		for (int tileCol = left / TILE_SIZE; tileCol <= right / TILE_SIZE; tileCol++)
+		{
+			auto it = m_occupied.find(static_cast<std::uint32_t>(tileRow * m_tilesPerRow + tileCol));
+			if (it == m_occupied.end())
+			{
+				continue;
+			}
+
+			int firstRow = std::max(top, tileRow * TILE_SIZE);
+			int lastRow = std::min(bottom, tileRow * TILE_SIZE + TILE_SIZE - 1);
+			int firstCol = std::max(left, tileCol * TILE_SIZE);
+			int lastCol = std::min(right, tileCol * TILE_SIZE + TILE_SIZE - 1);
+			WordType rowBits = ((WordType(1) << (lastCol - firstCol + 1)) - 1) << (firstCol % TILE_SIZE);
+			for (int r = firstRow; r <= lastRow; r++)
+			{
+				if (it->second & (rowBits << ((r % TILE_SIZE) * TILE_SIZE)))
+				{
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+bool SparseBoardCore::PlaceShip(int size, int row, int col, bool isHorizontal)
+{
+	if (!CanPlaceShip(size, row, col, isHorizontal))
+	{
+		return false;
+	}
+
+	int start = row * m_size + col;
+	int step = isHorizontal ? 1 : m_size;
+	for (int i = 0; i < size; i++)
+	{
+		SetBit(m_occupied, start + i * step);
+	}
+
+	m_shipStarts[start] = static_cast<int>(m_ships.size());
+	m_ships.push_back(ShipRecord{ start, static_cast<std::uint8_t>(size), isHorizontal });
+	m_remainingHits.push_back(static_cast<std::uint8_t>(size));
+	m_maxShipSize = std::max(m_maxShipSize, size);
+	m_aliveShipCount++;
+	m_remainingShipCells += size;
+	return true;
+}
+
+SparseBoardCore::UndoType SparseBoardCore::ApplyShot(int index)
+{
+	// Выстрел за пределы поля считаем промахом и не запоминаем
+	if (index < 0 || index >= m_size * m_size)
+	{
+		return { WideCell(), Ship::ShotResult::eMiss };
+	}
+
+	if (IsShot(index))
+	{
+		return { WideCell(), Ship::ShotResult::eAlreadyShot };
+	}
+	SetBit(m_shots, index);
+
+	if (!IsOccupied(index))
+	{
+		return { WideCell(index), Ship::ShotResult::eMiss };
+	}
+
+	int shipId = FindShip(index);
+	m_remainingShipCells--;
+	if (--m_remainingHits[shipId] == 0)
+	{
+		m_aliveShipCount--;
+		return { WideCell(index), Ship::ShotResult::eSunk };
+	}
+	return { WideCell(index), Ship::ShotResult::eHit };
+}
+
+void SparseBoardCore::UndoShot(const UndoType& undo)
+{
+	if (!undo.cell.IsValid())
+	{
+		return;
+	}
+
+	int index = undo.cell.GetIndex();
+	ResetBit(m_shots, index);
+	if (!IsOccupied(index))
+	{
+		return;
+	}
+
+	int shipId = FindShip(index);
+	m_remainingShipCells++;
+	if (m_remainingHits[shipId]++ == 0)
+	{
+		m_aliveShipCount++;
+	}
+}
+
+char SparseBoardCore::GetViewCell(bool forOwner, int index) const
+{
+	bool occupied = IsOccupied(index);
+	if (IsShot(index))
+	{
+		return occupied ? VIEW_HIT : VIEW_MISS;
+	}
+	return forOwner && occupied ? VIEW_SHIP : VIEW_UNKNOWN;
+}
+
+int SparseBoardCore::FindShip(int index) const
+{
+	// Корабль, накрывающий клетку, начинается не дальше m_maxShipSize - 1 клеток
+	// левее (горизонтальный) или выше (вертикальный)
+	int row = index / m_size;
+	int col = index % m_size;
+	for (int offset = 0; offset < m_maxShipSize; offset++)
+	{
+		if (col - offset >= 0)
+		{
+			auto it = m_shipStarts.find(index - offset);
+			if (it != m_shipStarts.end() && m_ships[it->second].size > offset &&
+				(offset == 0 || m_ships[it->second].isHorizontal))
+			{
+				return it->second;
+			}
+		}
+		if (offset > 0 && row - offset >= 0)
+		{
+			auto it = m_shipStarts.find(index - offset * m_size);
+			if (it != m_shipStarts.end() && m_ships[it->second].size > offset && !m_ships[it->second].isHorizontal)
+			{
+				return it->second;
+			}
+		}
+	}
+	return NO_SHIP;
+}
+
+bool SparseBoardCore::TestBit(const TilesType& tiles, int index) const
+{
+	int row = index / m_size;
+	int col = index % m_size;
+	auto it = tiles.find(TileKey(row, col));
+	return it != tiles.end() && ((it->second >> TileBit(row, col)) & 1);
+}
+
+void SparseBoardCore::SetBit(TilesType& tiles, int index)
+{
+	int row = index / m_size;
+	int col = index % m_size;
+	tiles[TileKey(row, col)] |= WordType(1) << TileBit(row, col);
+}
+
+void SparseBoardCore::ResetBit(TilesType& tiles, int index)
+{
+	// Пустые плитки удаляются, чтобы отмена возвращала таблицу к прежнему виду
+	int row = index / m_size;
+	int col = index % m_size;
+	auto it = tiles.find(TileKey(row, col));
+	if (it == tiles.end())
+	{
+		return;
+	}
+	it->second &= ~(WordType(1) << TileBit(row, col));
+	if (it->second == 0)
+	{
+		tiles.erase(it);
+	}
+}
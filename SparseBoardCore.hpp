@@ -0,0 +1,100 @@
+﻿#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <span>
+#include "Cell.hpp"
+#include "Ship.hpp"
+#include "BoardCore.hpp"
+
+// Состояние очень большого поля (больше GameBoard::MAX_DENSE_BOARD_SIZE).
+// Ничего не хранится на каждую клетку: выстрелы и клетки кораблей лежат
+// в хеш-таблицах плиток 8x8 (одно 64-битное слово на плитку), корабли ищутся
+// по начальной клетке. Память растет с числом выстрелов и кораблей, а не с
+// площадью поля. Готовых видов нет - символ клетки вычисляется по запросу.
+class SparseBoardCore
+{
+public:
+	static const int TILE_SIZE = 8;   // Плитка TILE_SIZE x TILE_SIZE - одно слово
+	static constexpr int NO_SHIP = -1;
+	static constexpr char VIEW_UNKNOWN = BoardCore<0>::VIEW_UNKNOWN;
+	static constexpr char VIEW_SHIP = BoardCore<0>::VIEW_SHIP;
+	static constexpr char VIEW_HIT = BoardCore<0>::VIEW_HIT;
+	static constexpr char VIEW_MISS = BoardCore<0>::VIEW_MISS;
+
+	// Положение корабля на поле
+	struct ShipRecord
+	{
+		int start;
+		std::uint8_t size;
+		bool isHorizontal;
+
+		bool operator==(const ShipRecord& other) const = default;
+	};
+
+	// публичные: переопределение типом
+	using WordType = std::uint64_t;
+	using TilesType = std::unordered_map<std::uint32_t, WordType>;   // Только непустые плитки
+	using ShipStartsType = std::unordered_map<int, int>;             // Начальная клетка -> номер корабля
+	using ShipRecordsType = std::vector<ShipRecord>;
+	using RemainingHitsType = std::vector<std::uint8_t>;
+	using ViewType = std::span<const char>;
+	using UndoType = WideShotUndo;   // Индекс клетки большого поля не помещается в 16 бит
+
+public:
+	// конструкторы и деконструктор
+	explicit SparseBoardCore(int size);
+	~SparseBoardCore() = default;
+
+	// публичные методы
+	bool CanPlaceShip(int size, int row, int col, bool isHorizontal) const;
+	bool PlaceShip(int size, int row, int col, bool isHorizontal);
+	Ship::ShotResult ReceiveShot(int index) { return ApplyShot(index).result; }
+	template <class CellType>
+	void ReceiveShots(std::span<const CellType> cells, std::span<Ship::ShotResult> results)
+	{
+		for (size_t i = 0; i < cells.size(); i++)
+		{
+			results[i] = ApplyShot(cells[i].GetIndex()).result;
+		}
+	}
+	UndoType ApplyShot(int index);
+	void UndoShot(const UndoType& undo);
+	bool operator==(const SparseBoardCore& other) const = default;
+	bool IsAllShipsSunk() const { return m_remainingShipCells == 0; }
+	bool IsShot(int index) const { return TestBit(m_shots, index); }
+	bool IsOccupied(int index) const { return TestBit(m_occupied, index); }
+	char GetViewCell(bool forOwner, int index) const;
+
+	// геттеры
+	int GetSize() const { return m_size; }
+	int GetShipCount() const { return static_cast<int>(m_ships.size()); }
+	int GetAliveShipCount() const { return m_aliveShipCount; }
+	const ShipRecord& GetShipRecord(int shipId) const { return m_ships[shipId]; }
+	int GetRemainingHits(int shipId) const { return m_remainingHits[shipId]; }
+	ViewType GetView(bool) const { return ViewType(); }   // Вид целиком не хранится, GameBoard::GetView это не допускает
+	size_t GetShotTileCount() const { return m_shots.size(); }
+
+private:
+	// приватные методы
+	int FindShip(int index) const;
+	std::uint32_t TileKey(int row, int col) const { return static_cast<std::uint32_t>((row / TILE_SIZE) * m_tilesPerRow + col / TILE_SIZE); }
+	static int TileBit(int row, int col) { return (row % TILE_SIZE) * TILE_SIZE + col % TILE_SIZE; }
+	bool TestBit(const TilesType& tiles, int index) const;
+	void SetBit(TilesType& tiles, int index);
+	void ResetBit(TilesType& tiles, int index);
+
+private:
+	// приватные переменные
+	int m_size;
+	int m_tilesPerRow;
+	int m_maxShipSize;
+	int m_aliveShipCount;
+	long long m_remainingShipCells;
+	TilesType m_occupied;
+	TilesType m_shots;
+	ShipRecordsType m_ships;
+	RemainingHitsType m_remainingHits;
+	ShipStartsType m_shipStarts;
+};
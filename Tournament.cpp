@@ -0,0 +1,159 @@
+﻿#include "Tournament.hpp"
+#include <atomic>
+#include <thread>
+#include <fstream>
+#include <algorithm>
+
+namespace
+{
+	// Диапазон партий одного потока. Владелец и "воры" забирают из него
+	// порции по CHUNK_SIZE через общий атомарный счетчик.
+	struct alignas(64) WorkRange
+	{
+		std::atomic<long long> next{ 0 };
+		long long end = 0;
+	};
+
+	// Перемешивание SplitMix64
+	std::uint64_t Mix(std::uint64_t value)
+	{
+		value += 0x9E3779B97F4A7C15ull;
+		value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+		value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+		return value ^ (value >> 31);
+	}
+}
+
+Tournament::Tournament(int boardSize, std::uint64_t seed, int threadCount,
+	AIPlayer::Strategy firstStrategy, AIPlayer::Strategy secondStrategy)
+	: m_boardSize(boardSize)
+	, m_rules(GameBoard::MakeRules(boardSize))
+	, m_seed(seed)
+	, m_threadCount(threadCount > 0 ? threadCount : std::max(1u, std::thread::hardware_concurrency()))
+	, m_strategies{ firstStrategy, secondStrategy }
+	, m_layoutPool(nullptr)
+	, m_wins{ 0, 0 }
+	, m_unfinished(0)
+	, m_totalShots(0)
+{
+}
+
+std::uint64_t Tournament::DeriveSeed(std::uint64_t seed, std::uint64_t index)
+{
+	return Mix(Mix(seed) ^ index);
+}
+
+GameRecord Tournament::PlayGame(MatchEngine& engine, std::uint64_t gameSeed) const
+{
+	AIPlayer first("ИИ 1", m_rules, static_cast<std::uint32_t>(DeriveSeed(gameSeed, 0)), m_strategies[0]);
+	AIPlayer second("ИИ 2", m_rules, static_cast<std::uint32_t>(DeriveSeed(gameSeed, 1)), m_strategies[1]);
+	first.SetSamplerSettings(m_samplerSettings);
+	second.SetSamplerSettings(m_samplerSettings);
+	first.SetLayoutPool(m_layoutPool);
+	second.SetLayoutPool(m_layoutPool);
+
+	const MatchResult& result = engine.Run(first, second);
+
+	// Партия, где флот не расставился, тоже считается незавершенной
+	GameRecord record;
+	record.winner = result.winner == MatchResult::NO_WINNER
+		? NO_WINNER_RECORD
+		: static_cast<std::uint8_t>(result.winner);
+	record.shotCount = static_cast<std::uint32_t>(result.shotCount);
+	return record;
+}
+
+void Tournament::Run(long long gameCount)
+{
+	m_records.assign(static_cast<size_t>(std::max(gameCount, 0LL)), GameRecord{ NO_WINNER_RECORD, 0 });
+
+	// Делим партии на равные непрерывные диапазоны по потокам
+	std::vector<WorkRange> ranges(m_threadCount);
+	for (int i = 0; i < m_threadCount; i++)
+	{
+		ranges[i].next = gameCount * i / m_threadCount;
+		ranges[i].end = gameCount * (i + 1) / m_threadCount;
+	}
+
+	auto worker = [this, &ranges](int self)
+	{
+		MatchEngine engine(false);
+
+		// Сначала свой диапазон, затем крадем порции у остальных потоков
+		for (int offset = 0; offset < m_threadCount; offset++)
+		{
+			WorkRange& range = ranges[(self + offset) % m_threadCount];
+			while (true)
+			{
+				long long begin = range.next.fetch_add(CHUNK_SIZE, std::memory_order_relaxed);
+				if (begin >= range.end)
+				{
+					break;
+				}
+
+				long long end = std::min(begin + CHUNK_SIZE, range.end);
+				for (long long game = begin; game < end; game++)
+				{
+					m_records[game] = PlayGame(engine, DeriveSeed(m_seed, game));
+				}
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (int i = 1; i < m_threadCount; i++)
+	{
+		threads.emplace_back(worker, i);
+	}
+	worker(0);
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+
+	// Сводка считается после завершения всех потоков
+	m_wins[0] = m_wins[1] = 0;
+	m_unfinished = 0;
+	m_totalShots = 0;
+	for (const auto& record : m_records)
+	{
+		if (record.winner == NO_WINNER_RECORD)
+		{
+			m_unfinished++;
+		}
+		else
+		{
+			m_wins[record.winner]++;
+		}
+		m_totalShots += record.shotCount;
+	}
+}
+
+bool Tournament::WriteResults(const std::string& path) const
+{
+	std::ofstream file(path);
+	if (!file)
+	{
+		return false;
+	}
+
+	// Только детерминированные данные, чтобы файлы разных сборок можно было сравнивать
+	file << "# seed " << m_seed << " board " << m_boardSize << " games " << m_records.size()
+		<< " strategies " << static_cast<int>(m_strategies[0]) << " " << static_cast<int>(m_strategies[1]) << "\n";
+	file << "# wins " << m_wins[0] << " " << m_wins[1] << " unfinished " << m_unfinished
+		<< " shots " << m_totalShots << "\n";
+
+	std::string line;
+	for (size_t i = 0; i < m_records.size(); i++)
+	{
+		line = std::to_string(i);
+		line += ' ';
+		line += m_records[i].winner == NO_WINNER_RECORD ? "-" : std::to_string(m_records[i].winner);
+		line += ' ';
+		line += std::to_string(m_records[i].shotCount);
+		line += '\n';
+		file << line;
+	}
+
+	return static_cast<bool>(file);
+}
@@ -0,0 +1,67 @@
+﻿#pragma once
+
+#include "MatchEngine.hpp"
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// Итог одной партии турнира в компактном виде
+struct GameRecord
+{
+	std::uint8_t winner;      // 0, 1 или NO_WINNER_RECORD
+	std::uint32_t shotCount;  // Общее число выстрелов в партии
+};
+
+// Партия длится не больше двух выстрелов на клетку, поэтому счетчик не переполняется
+static_assert(2LL * GameBoard::MAX_BOARD_SIZE * GameBoard::MAX_BOARD_SIZE <= 0xFFFFFFFFLL, "Число выстрелов партии не помещается в GameRecord");
+
+// Турнир ИИ против ИИ на всех ядрах.
+// Каждая партия получает зерно из пары (зерно турнира, номер партии),
+// а итог записывается в ячейку с номером партии, поэтому результаты
+// не зависят ни от числа потоков, ни от порядка выполнения.
+class Tournament
+{
+public:
+	static const std::uint8_t NO_WINNER_RECORD = 0xFF;
+	static const long long CHUNK_SIZE = 64;
+
+	// публичные: переопределение типом
+	using RecordsType = std::vector<GameRecord>;
+
+public:
+	// конструкторы и деконструктор
+	Tournament(int boardSize, std::uint64_t seed, int threadCount,
+		AIPlayer::Strategy firstStrategy = AIPlayer::Strategy::eRandomHunt,
+		AIPlayer::Strategy secondStrategy = AIPlayer::Strategy::eRandomHunt);
+	~Tournament() = default;
+
+	// публичные методы
+	void Run(long long gameCount);
+	bool WriteResults(const std::string& path) const;
+	static std::uint64_t DeriveSeed(std::uint64_t seed, std::uint64_t index);
+	GameRecord PlayGame(MatchEngine& engine, std::uint64_t gameSeed) const;
+	void SetSamplerSettings(const AIPlayer::SamplerSettings& settings) { m_samplerSettings = settings; }
+	void SetLayoutPool(LayoutPool* pool) { m_layoutPool = pool; }
+	void SetRules(const RuleChoice& rules) { m_rules = rules; m_boardSize = rules.boardSize; }   // По умолчанию GameBoard::MakeRules   // С пулом расстановки не зависят от зерна партии
+
+	// геттеры
+	const RecordsType& GetRecords() const { return m_records; }
+	long long GetWins(int player) const { return m_wins[player]; }
+	long long GetUnfinished() const { return m_unfinished; }
+	long long GetTotalShots() const { return m_totalShots; }
+	int GetThreadCount() const { return m_threadCount; }
+
+private:
+	// приватные переменные
+	int m_boardSize;
+	RuleChoice m_rules;
+	std::uint64_t m_seed;
+	int m_threadCount;
+	AIPlayer::Strategy m_strategies[2];
+	AIPlayer::SamplerSettings m_samplerSettings;
+	LayoutPool* m_layoutPool;
+	RecordsType m_records;
+	long long m_wins[2];
+	long long m_unfinished;
+	long long m_totalShots;
+};
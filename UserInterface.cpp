@@ -1,6 +1,7 @@
 ﻿#include "UserInterface.hpp"
 #include "GameManager.hpp"
 #include <iostream>
+#include <algorithm>
 
 UserInterface::UserInterface(GameManager* manager)
 	: m_gameManager(manager)
@@ -16,47 +17,11 @@ void UserInterface::DisplayBoards(Player* player)
 
 	// Поле игрока - показываем корабли (forOwner = true)
 	std::cout << "=== ВАШЕ ПОЛЕ ===\n";
-	auto myState = player->GetMyBoard().GetVisibleState(true);
-
-	// Вывод номеров столбцов
-	std::cout << "  ";
-	for (int j = 0; j < player->GetMyBoard().GetSize(); j++)
-	{
-		std::cout << j << " ";
-	}
-	std::cout << "\n";
-
-	for (int i = 0; i < player->GetMyBoard().GetSize(); i++)
-	{
-		std::cout << i << " ";
-		for (int j = 0; j < player->GetMyBoard().GetSize(); j++)
-		{
-			std::cout << myState[i][j] << " ";
-		}
-		std::cout << "\n";
-	}
+	DisplayGrid(player->GetMyBoard(), true);
 
 	// Поле противника - НЕ показываем корабли (forOwner = false)
 	std::cout << "\n=== ПОЛЕ ПРОТИВНИКА ===\n";
-	auto enemyState = player->GetEnemyBoard()->GetVisibleState(false);
-
-	// Вывод номеров столбцов
-	std::cout << "  ";
-	for (int j = 0; j < player->GetEnemyBoard()->GetSize(); j++)
-	{
-		std::cout << j << " ";
-	}
-	std::cout << "\n";
-
-	for (int i = 0; i < player->GetEnemyBoard()->GetSize(); i++)
-	{
-		std::cout << i << " ";
-		for (int j = 0; j < player->GetEnemyBoard()->GetSize(); j++)
-		{
-			std::cout << enemyState[i][j] << " ";
-		}
-		std::cout << "\n";
-	}
+	DisplayGrid(*player->GetEnemyBoard(), false);
 
 	// Легенда
 	DisplayLegend();
@@ -84,28 +49,42 @@ void UserInterface::ShowGameOver(const std::string& winnerName)
 			std::cout << "\n=== РАСКРЫТОЕ ПОЛЕ ПРОТИВНИКА ===\n";
 
 			// Используем forOwner = true чтобы показать все корабли противника
-			auto revealedState = currentPlayer->GetEnemyBoard()->GetVisibleState(true);
+			DisplayGrid(*currentPlayer->GetEnemyBoard(), true);
+		}
+	}
+	std::cout << "========================================\n";
+}
+
+void UserInterface::DisplayGrid(const GameBoard& board, bool forOwner)
+{
+	// Строится только видимое окно, поэтому большое поле не разворачивается целиком
+	int height = std::min(board.GetSize(), MAX_VIEWPORT_SIZE);
+	int width = std::min(board.GetSize(), MAX_VIEWPORT_SIZE);
+	GameBoard::ViewportType viewport;
+	board.GetViewport(forOwner, 0, 0, height, width, viewport);
+
+	if (height < board.GetSize())
+	{
+		std::cout << "(показан угол " << height << "x" << width << " поля " << board.GetSize() << "x" << board.GetSize() << ")\n";
+	}
 
-			// Вывод номеров столбцов
-			std::cout << "  ";
-			for (int j = 0; j < currentPlayer->GetEnemyBoard()->GetSize(); j++)
-			{
-				std::cout << j << " ";
-			}
-			std::cout << "\n";
+	// Вывод номеров столбцов
+	std::cout << "  ";
+	for (int j = 0; j < width; j++)
+	{
+		std::cout << j << " ";
+	}
+	std::cout << "\n";
 
-			for (int i = 0; i < currentPlayer->GetEnemyBoard()->GetSize(); i++)
-			{
-				std::cout << i << " ";
-				for (int j = 0; j < currentPlayer->GetEnemyBoard()->GetSize(); j++)
-				{
-					std::cout << revealedState[i][j] << " ";
-				}
-				std::cout << "\n";
-			}
+	for (int i = 0; i < height; i++)
+	{
+		std::cout << i << " ";
+		for (int j = 0; j < width; j++)
+		{
+			std::cout << viewport[i * width + j] << " ";
 		}
+		std::cout << "\n";
 	}
-	std::cout << "========================================\n";
 }
 
 void UserInterface::DisplayLegend()
@@ -9,6 +9,8 @@ class GameManager;
 class UserInterface
 {
 public:
+	static const int MAX_VIEWPORT_SIZE = 20;   // Большое поле показывается окном не больше этого размера
+
 	// конструкторы и деконструктор
 	UserInterface(GameManager* manager);
 	~UserInterface() = default;
@@ -19,6 +21,10 @@ public:
 	void ShowGameOver(const std::string& winnerName);
 	void DisplayLegend();
 
+private:
+	// приватные методы
+	void DisplayGrid(const GameBoard& board, bool forOwner);
+
 private:
 	// приватные переменные
 	GameManager* m_gameManager;